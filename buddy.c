@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BUDDY_ORDERS 31           // Block sizes from 1 KB up to 2^30 KB
+#define BUDDY_MAX_SLOTS (1 << 20) // Smallest blocks the free lists index at most
+
+// Define a structure to represent a binary buddy allocator over contiguous
+// memory. Every block is a power of two in size, no smaller than the
+// smallest block, and aligned to its size; free blocks of each order sit on
+// a doubly linked list threaded through arrays indexed by smallest block,
+// so a freed block can find and unlink its buddy in constant time. The
+// smallest block is 1 KB unless the memory holds more than BUDDY_MAX_SLOTS
+// of them, when it grows so that the arrays stay that size.
+struct BuddyAllocator
+{
+    int size;                // Memory size in KB
+    int min_order;           // Order of the smallest block
+    int slots;               // Smallest blocks in the memory
+    int *next;               // Address of the next free block of the same order, -1 at the end
+    int *prev;               // Address of the previous free block of the same order, -1 at the head
+    signed char *free_order; // Order of the free block starting in the slot, -1 if none
+    int heads[BUDDY_ORDERS]; // First free block of each order, -1 if none
+    unsigned int nonempty;   // Bit k is set when order k has a free block
+    int free_total;          // Sum of the free block sizes in KB
+};
+
+// Function to get the order of the smallest block that holds the size
+int buddyOrder(struct BuddyAllocator *buddy, int size)
+{
+    int order = buddy->min_order;
+    while (order < BUDDY_ORDERS - 1 && (1 << order) < size)
+        order++;
+    return order;
+}
+
+// Function to get the size of the block that holds the size
+int buddyBlockSize(struct BuddyAllocator *buddy, int size)
+{
+    return 1 << buddyOrder(buddy, size);
+}
+
+void pushBuddyBlock(struct BuddyAllocator *buddy, int start, int order)
+{
+    int slot = start >> buddy->min_order;
+    buddy->free_order[slot] = (signed char)order;
+    buddy->prev[slot] = -1;
+    buddy->next[slot] = buddy->heads[order];
+    if (buddy->heads[order] != -1)
+        buddy->prev[buddy->heads[order] >> buddy->min_order] = start;
+    buddy->heads[order] = start;
+    buddy->nonempty |= 1u << order;
+    buddy->free_total += 1 << order;
+}
+
+void unlinkBuddyBlock(struct BuddyAllocator *buddy, int start, int order)
+{
+    int slot = start >> buddy->min_order;
+    if (buddy->prev[slot] != -1)
+        buddy->next[buddy->prev[slot] >> buddy->min_order] = buddy->next[slot];
+    else
+        buddy->heads[order] = buddy->next[slot];
+    if (buddy->next[slot] != -1)
+        buddy->prev[buddy->next[slot] >> buddy->min_order] = buddy->prev[slot];
+    if (buddy->heads[order] == -1)
+        buddy->nonempty &= ~(1u << order);
+    buddy->free_order[slot] = -1;
+    buddy->free_total -= 1 << order;
+}
+
+// Function to create an allocator with the whole memory free. A memory size
+// that is not a power of two is covered by the largest aligned blocks that
+// fit; a tail shorter than the smallest block is never handed out.
+struct BuddyAllocator *createBuddyAllocator(int memory_size)
+{
+    struct BuddyAllocator *buddy = (struct BuddyAllocator *)malloc(sizeof(struct BuddyAllocator));
+    if (buddy == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    buddy->size = memory_size;
+    buddy->min_order = 0;
+    while ((memory_size >> buddy->min_order) > BUDDY_MAX_SLOTS)
+        buddy->min_order++;
+    buddy->slots = memory_size >> buddy->min_order;
+    buddy->next = (int *)malloc(buddy->slots * sizeof(int));
+    buddy->prev = (int *)malloc(buddy->slots * sizeof(int));
+    buddy->free_order = (signed char *)malloc(buddy->slots);
+    if (buddy->next == NULL || buddy->prev == NULL || buddy->free_order == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    buddy->nonempty = 0;
+    buddy->free_total = 0;
+    for (int order = 0; order < BUDDY_ORDERS; order++)
+    {
+        buddy->heads[order] = -1;
+    }
+    for (int slot = 0; slot < buddy->slots; slot++)
+    {
+        buddy->free_order[slot] = -1;
+    }
+
+    int start = 0;
+    while (memory_size - start >= 1 << buddy->min_order)
+    {
+        int order = BUDDY_ORDERS - 1;
+        while ((1 << order) > memory_size - start || start % (1 << order) != 0)
+            order--;
+        pushBuddyBlock(buddy, start, order);
+        start += 1 << order;
+    }
+    return buddy;
+}
+
+// Function to take a block that holds the size, splitting a larger block
+// when no block of the right order is free.
+// Returns the start address, or -1 if no block is large enough.
+int buddyAllocate(struct BuddyAllocator *buddy, int size)
+{
+    int order = buddyOrder(buddy, size);
+    unsigned int candidates = buddy->nonempty >> order << order; // Free orders large enough
+    if (candidates == 0)
+        return -1;
+
+    int found = __builtin_ctz(candidates);
+    int start = buddy->heads[found];
+    unlinkBuddyBlock(buddy, start, found);
+
+    // Give back the upper half until the block is the right size
+    while (found > order)
+    {
+        found--;
+        pushBuddyBlock(buddy, start + (1 << found), found);
+    }
+    return start;
+}
+
+// Function to free the block holding the size at the address, merging it
+// with its buddy for as long as the buddy is free and whole
+void buddyFree(struct BuddyAllocator *buddy, int start, int size)
+{
+    int order = buddyOrder(buddy, size);
+    while (order < BUDDY_ORDERS - 1)
+    {
+        int mate = start ^ (1 << order);
+        if (mate + (1 << order) > buddy->size || buddy->free_order[mate >> buddy->min_order] != order)
+            break;
+        unlinkBuddyBlock(buddy, mate, order);
+        if (mate < start)
+            start = mate;
+        order++;
+    }
+    pushBuddyBlock(buddy, start, order);
+}
+
+// Function to get the size of the largest free block
+int buddyLargest(struct BuddyAllocator *buddy)
+{
+    return buddy->nonempty == 0 ? 0 : 1 << (31 - __builtin_clz(buddy->nonempty));
+}
+
+// Function to get the size of the memory the blocks cover, which leaves
+// out a tail shorter than the smallest block
+int buddyCovered(struct BuddyAllocator *buddy)
+{
+    return buddy->size >> buddy->min_order << buddy->min_order;
+}
+
+// Function to check whether the block holding the size at the address is
+// one the allocator could have handed out and no part of it is free
+int buddyBlockHeld(struct BuddyAllocator *buddy, int start, int size)
+{
+    int order = buddyOrder(buddy, size);
+    if (start % (1 << order) != 0 || start > buddy->size - (1 << order))
+        return 0;
+
+    // No free block may start inside it or hold it
+    for (int slot = start >> buddy->min_order; slot < (start + (1 << order)) >> buddy->min_order; slot++)
+    {
+        if (buddy->free_order[slot] != -1)
+            return 0;
+    }
+    for (int larger = order + 1; larger < BUDDY_ORDERS; larger++)
+    {
+        int outer = start & ~((1 << larger) - 1);
+        if (outer <= buddy->size - (1 << larger) && buddy->free_order[outer >> buddy->min_order] == larger)
+            return 0;
+    }
+    return 1;
+}
+
+void freeBuddyAllocator(struct BuddyAllocator *buddy)
+{
+    free(buddy->next);
+    free(buddy->prev);
+    free(buddy->free_order);
+    free(buddy);
+}
+
+// Function to write the free lists of the allocator
+void saveBuddyAllocator(struct Snapshot *snapshot, struct BuddyAllocator *buddy)
+{
+    writeSnapshotArray(snapshot, buddy->next, buddy->slots, sizeof(int));
+    writeSnapshotArray(snapshot, buddy->prev, buddy->slots, sizeof(int));
+    writeSnapshotArray(snapshot, buddy->free_order, buddy->slots, 1);
+    writeSnapshotArray(snapshot, buddy->heads, BUDDY_ORDERS, sizeof(int));
+    writeSnapshotInt(snapshot, (int)buddy->nonempty);
+    writeSnapshotInt(snapshot, buddy->free_total);
+}
+
+// Function to check that the address starts a block of the order that
+// lies inside the memory and is marked free at that order
+int buddyBlockValid(struct BuddyAllocator *buddy, int start, int order)
+{
+    return start >= 0 && start % (1 << order) == 0 && start <= buddy->size - (1 << order) &&
+           buddy->free_order[start >> buddy->min_order] == order;
+}
+
+// Function to overwrite the free lists with those written by
+// saveBuddyAllocator() for a memory of the same size. Every list must run
+// from its head to its end through free blocks of its order, and hold
+// every block marked free at that order.
+void restoreBuddyAllocator(struct Snapshot *snapshot, struct BuddyAllocator *buddy)
+{
+    readSnapshotArray(snapshot, buddy->next, buddy->slots, sizeof(int));
+    readSnapshotArray(snapshot, buddy->prev, buddy->slots, sizeof(int));
+    readSnapshotArray(snapshot, buddy->free_order, buddy->slots, 1);
+    readSnapshotArray(snapshot, buddy->heads, BUDDY_ORDERS, sizeof(int));
+    buddy->nonempty = (unsigned int)readSnapshotInt(snapshot);
+    buddy->free_total = readSnapshotRange(snapshot, 0, buddy->size);
+    if (snapshot->failed)
+        return;
+
+    int marked = 0;
+    if (buddy->nonempty >> (BUDDY_ORDERS - 1) >> 1 != 0)
+        snapshot->failed = 1;
+    for (int slot = 0; slot < buddy->slots; slot++)
+    {
+        int order = buddy->free_order[slot];
+        if (order != -1 && (order < buddy->min_order || order >= BUDDY_ORDERS))
+            snapshot->failed = 1;
+        marked += order != -1;
+    }
+
+    // A block is reached only from the one before it, so no list can loop
+    int listed = 0;
+    long long free_total = 0;
+    for (int order = 0; order < BUDDY_ORDERS && !snapshot->failed; order++)
+    {
+        if ((buddy->heads[order] != -1) != ((buddy->nonempty >> order) & 1))
+            snapshot->failed = 1;
+        int previous = -1;
+        for (int start = buddy->heads[order]; start != -1; start = buddy->next[start >> buddy->min_order])
+        {
+            if (!buddyBlockValid(buddy, start, order) || buddy->prev[start >> buddy->min_order] != previous)
+            {
+                snapshot->failed = 1;
+                break;
+            }
+            previous = start;
+            listed++;
+            free_total += 1 << order;
+        }
+    }
+    if (listed != marked || free_total != buddy->free_total)
+        snapshot->failed = 1;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Define a structure to represent a record waiting to be written
+struct ConvertRecord
+{
+    int arrival_time;
+    int service_time;
+    int memory_size;
+    int tickets;
+    uint32_t name_index;
+    uint64_t sequence; // Position in the input, keeps the sort stable
+};
+
+// Define a structure to represent the interned process names
+struct NameTable
+{
+    char (*names)[MAX_NAME_LENGTH]; // Distinct names in order of first use
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;      // Open-addressing hash of name index + 1, 0 when empty
+    uint32_t slot_count;  // Always a power of two
+};
+
+void *growArray(void *array, size_t count, size_t size)
+{
+    void *grown = realloc(array, count * size);
+    if (grown == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+uint32_t hashName(const char *name)
+{
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (; *name != '\0'; name++)
+    {
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+    }
+    return hash;
+}
+
+// Rebuild the hash slots at twice the size
+void rehashNames(struct NameTable *table)
+{
+    table->slot_count = table->slot_count ? table->slot_count * 2 : 64;
+    free(table->slots);
+    table->slots = (uint32_t *)calloc(table->slot_count, sizeof(uint32_t));
+    if (table->slots == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < table->count; i++)
+    {
+        uint32_t slot = hashName(table->names[i]) & (table->slot_count - 1);
+        while (table->slots[slot] != 0)
+            slot = (slot + 1) & (table->slot_count - 1);
+        table->slots[slot] = i + 1;
+    }
+}
+
+// Function to return the index of a name, adding it on first use
+uint32_t internName(struct NameTable *table, const char *name)
+{
+    if (2 * (table->count + 1) > table->slot_count)
+        rehashNames(table);
+
+    uint32_t slot = hashName(name) & (table->slot_count - 1);
+    while (table->slots[slot] != 0)
+    {
+        uint32_t index = table->slots[slot] - 1;
+        if (strcmp(table->names[index], name) == 0)
+            return index;
+        slot = (slot + 1) & (table->slot_count - 1);
+    }
+
+    if (table->count == table->capacity)
+    {
+        table->capacity = table->capacity ? table->capacity * 2 : 64;
+        table->names = growArray(table->names, table->capacity, MAX_NAME_LENGTH);
+    }
+    memset(table->names[table->count], 0, MAX_NAME_LENGTH);
+    strcpy(table->names[table->count], name);
+    table->slots[slot] = table->count + 1;
+    return table->count++;
+}
+
+int compareConvertRecords(const void *a, const void *b)
+{
+    const struct ConvertRecord *left = (const struct ConvertRecord *)a;
+    const struct ConvertRecord *right = (const struct ConvertRecord *)b;
+    if (left->arrival_time != right->arrival_time)
+        return left->arrival_time < right->arrival_time ? -1 : 1;
+    return left->sequence < right->sequence ? -1 : left->sequence > right->sequence;
+}
+
+void writeLittleEndian32(char *bytes, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        bytes[i] = (char)(value >> (8 * i));
+    }
+}
+
+void writeLittleEndian64(char *bytes, uint64_t value)
+{
+    writeLittleEndian32(bytes, (uint32_t)value);
+    writeLittleEndian32(bytes + 4, (uint32_t)(value >> 32));
+}
+
+// Function to convert a text trace into the binary trace format.
+// Returns 0 on success.
+int convertTrace(const char *input_name, const char *output_name)
+{
+    struct TraceReader *reader = openTrace(input_name);
+    if (reader == NULL)
+        return 1;
+
+    struct ConvertRecord *records = NULL;
+    uint64_t record_count = 0, record_capacity = 0;
+    struct NameTable names = {NULL, 0, 0, NULL, 0};
+
+    while (hasTraceRecord(reader))
+    {
+        struct TraceRecord record = takeTraceRecord(reader);
+        if (record_count == record_capacity)
+        {
+            record_capacity = record_capacity ? record_capacity * 2 : 1024;
+            records = growArray(records, record_capacity, sizeof(struct ConvertRecord));
+        }
+        records[record_count].arrival_time = record.arrival_time;
+        records[record_count].service_time = record.service_time;
+        records[record_count].memory_size = record.memory_size;
+        records[record_count].tickets = record.tickets;
+        records[record_count].name_index = internName(&names, record.name);
+        records[record_count].sequence = record_count;
+        record_count++;
+    }
+    int failed = reader->failed;
+    closeTrace(reader);
+
+    FILE *output = failed ? NULL : fopen(output_name, "wb");
+    if (output == NULL)
+    {
+        if (!failed)
+            perror("Error opening output file");
+        free(records);
+        free(names.names);
+        free(names.slots);
+        return 1;
+    }
+
+    // Arrival order is what the scheduler admits processes in
+    qsort(records, record_count, sizeof(struct ConvertRecord), compareConvertRecords);
+
+    char header[BINARY_TRACE_HEADER_SIZE] = {0};
+    uint64_t names_offset = BINARY_TRACE_HEADER_SIZE + record_count * BINARY_TRACE_RECORD_SIZE;
+    memcpy(header, BINARY_TRACE_MAGIC, 4);
+    writeLittleEndian32(header + 4, BINARY_TRACE_VERSION);
+    writeLittleEndian64(header + 8, record_count);
+    writeLittleEndian32(header + 16, names.count);
+    writeLittleEndian64(header + 24, names_offset);
+    fwrite(header, 1, sizeof(header), output);
+
+    for (uint64_t i = 0; i < record_count; i++)
+    {
+        char bytes[BINARY_TRACE_RECORD_SIZE];
+        writeLittleEndian32(bytes, (uint32_t)records[i].arrival_time);
+        writeLittleEndian32(bytes + 4, (uint32_t)records[i].service_time);
+        writeLittleEndian32(bytes + 8, (uint32_t)records[i].memory_size);
+        writeLittleEndian32(bytes + 12, records[i].name_index);
+        writeLittleEndian32(bytes + 16, (uint32_t)records[i].tickets);
+        fwrite(bytes, 1, sizeof(bytes), output);
+    }
+    fwrite(names.names, MAX_NAME_LENGTH, names.count, output);
+
+    int error = ferror(output);
+    if (fclose(output) != 0 || error)
+    {
+        perror("Error writing output file");
+        error = 1;
+    }
+
+    free(records);
+    free(names.names);
+    free(names.slots);
+    return error;
+}
@@ -0,0 +1,430 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// Define a structure to represent a free extent (hole) in contiguous memory.
+// Extents are kept in a treap ordered by start address, and every node
+// remembers the largest hole in its subtree so first-fit can skip whole
+// subtrees that are too small. The same nodes are also linked into a second
+// treap ordered by length (then address), which best-fit searches.
+struct Extent
+{
+    int start;              // Start address of the hole
+    int length;             // Length of the hole in KB
+    int max_length;         // Largest hole in this subtree
+    unsigned int priority;  // Heap priority that keeps the treap balanced
+    struct Extent *left;
+    struct Extent *right;
+    struct Extent *size_left;  // Children in the length-ordered treap
+    struct Extent *size_right;
+};
+
+// Define a structure to represent the ordered set of free extents
+struct ExtentTree
+{
+    struct Extent *root;
+    struct Extent *size_root; // The same extents ordered by length
+    unsigned int seed;        // Deterministic priority generator
+    int free_total;           // Sum of the hole lengths in KB
+};
+
+// Function to create a new extent node
+struct Extent *createExtent(struct ExtentTree *tree, int start, int length)
+{
+    struct Extent *extent = (struct Extent *)malloc(sizeof(struct Extent));
+    if (extent == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    // xorshift keeps priorities pseudo-random but reproducible between runs
+    tree->seed ^= tree->seed << 13;
+    tree->seed ^= tree->seed >> 17;
+    tree->seed ^= tree->seed << 5;
+    extent->start = start;
+    extent->length = length;
+    extent->max_length = length;
+    extent->priority = tree->seed;
+    extent->left = extent->right = NULL;
+    extent->size_left = extent->size_right = NULL;
+    return extent;
+}
+
+int extentMax(struct Extent *extent)
+{
+    return extent == NULL ? 0 : extent->max_length;
+}
+
+// Recompute the largest hole of a node from its children
+void updateExtent(struct Extent *extent)
+{
+    int max_length = extent->length;
+    if (extentMax(extent->left) > max_length)
+        max_length = extentMax(extent->left);
+    if (extentMax(extent->right) > max_length)
+        max_length = extentMax(extent->right);
+    extent->max_length = max_length;
+}
+
+// Split a subtree into extents starting before the address and the rest
+void splitExtents(struct Extent *extent, int address, struct Extent **left, struct Extent **right)
+{
+    if (extent == NULL)
+    {
+        *left = *right = NULL;
+        return;
+    }
+    if (extent->start < address)
+    {
+        splitExtents(extent->right, address, &extent->right, right);
+        *left = extent;
+    }
+    else
+    {
+        splitExtents(extent->left, address, left, &extent->left);
+        *right = extent;
+    }
+    updateExtent(extent);
+}
+
+// Join two subtrees where every extent of the left precedes the right
+struct Extent *mergeExtents(struct Extent *left, struct Extent *right)
+{
+    if (left == NULL)
+        return right;
+    if (right == NULL)
+        return left;
+    if (left->priority > right->priority)
+    {
+        left->right = mergeExtents(left->right, right);
+        updateExtent(left);
+        return left;
+    }
+    right->left = mergeExtents(left, right->left);
+    updateExtent(right);
+    return right;
+}
+
+// Check whether an extent comes before the given length and address in the
+// length-ordered treap
+int extentSizeBefore(struct Extent *extent, int length, int start)
+{
+    return extent->length < length || (extent->length == length && extent->start < start);
+}
+
+// Split the length-ordered treap into extents before the key and the rest
+void splitExtentSizes(struct Extent *extent, int length, int start, struct Extent **left, struct Extent **right)
+{
+    if (extent == NULL)
+    {
+        *left = *right = NULL;
+        return;
+    }
+    if (extentSizeBefore(extent, length, start))
+    {
+        splitExtentSizes(extent->size_right, length, start, &extent->size_right, right);
+        *left = extent;
+    }
+    else
+    {
+        splitExtentSizes(extent->size_left, length, start, left, &extent->size_left);
+        *right = extent;
+    }
+}
+
+struct Extent *mergeExtentSizes(struct Extent *left, struct Extent *right)
+{
+    if (left == NULL)
+        return right;
+    if (right == NULL)
+        return left;
+    if (left->priority > right->priority)
+    {
+        left->size_right = mergeExtentSizes(left->size_right, right);
+        return left;
+    }
+    right->size_left = mergeExtentSizes(left, right->size_left);
+    return right;
+}
+
+void insertExtentSize(struct ExtentTree *tree, struct Extent *extent)
+{
+    struct Extent *before, *after;
+    splitExtentSizes(tree->size_root, extent->length, extent->start, &before, &after);
+    extent->size_left = extent->size_right = NULL;
+    tree->size_root = mergeExtentSizes(mergeExtentSizes(before, extent), after);
+    tree->free_total += extent->length;
+}
+
+void removeExtentSize(struct ExtentTree *tree, struct Extent *extent)
+{
+    struct Extent *before, *rest, *after;
+    splitExtentSizes(tree->size_root, extent->length, extent->start, &before, &rest);
+    splitExtentSizes(rest, extent->length, extent->start + 1, &rest, &after);
+    tree->size_root = mergeExtentSizes(before, after);
+    tree->free_total -= extent->length;
+}
+
+// Function to initialise the tree with one hole covering the whole memory
+struct ExtentTree *createExtentTree(int memory_size)
+{
+    struct ExtentTree *tree = (struct ExtentTree *)malloc(sizeof(struct ExtentTree));
+    if (tree == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    tree->seed = 2463534242u;
+    tree->root = tree->size_root = NULL;
+    tree->free_total = 0;
+    if (memory_size > 0)
+    {
+        tree->root = createExtent(tree, 0, memory_size);
+        insertExtentSize(tree, tree->root);
+    }
+    return tree;
+}
+
+// Carve the requested size off the front of the hole starting at the address
+struct Extent *carveExtent(struct Extent *extent, int start, int size)
+{
+    if (extent->start == start)
+    {
+        if (extent->length == size)
+        {
+            // The hole is used up entirely, so drop its node
+            struct Extent *merged = mergeExtents(extent->left, extent->right);
+            free(extent);
+            return merged;
+        }
+        extent->start += size;
+        extent->length -= size;
+    }
+    else if (start < extent->start)
+        extent->left = carveExtent(extent->left, start, size);
+    else
+        extent->right = carveExtent(extent->right, start, size);
+    updateExtent(extent);
+    return extent;
+}
+
+// Take the size off the front of a hole in both treaps. Returns its start.
+int takeExtent(struct ExtentTree *tree, struct Extent *extent, int size)
+{
+    int start = extent->start;
+    int used_up = extent->length == size;
+    removeExtentSize(tree, extent);
+    tree->root = carveExtent(tree->root, start, size);
+    if (!used_up)
+        insertExtentSize(tree, extent); // Carved in place, so it is still this node
+    return start;
+}
+
+// Find the lowest-addressed hole at or after the address that fits the size
+struct Extent *findExtentFrom(struct Extent *extent, int address, int size)
+{
+    if (extent == NULL || extent->max_length < size)
+        return NULL;
+    if (extent->start < address)
+        return findExtentFrom(extent->right, address, size);
+    struct Extent *found = findExtentFrom(extent->left, address, size);
+    if (found != NULL)
+        return found;
+    if (extent->length >= size)
+        return extent;
+    return findExtentFrom(extent->right, address, size);
+}
+
+// Function to take the lowest-addressed hole that fits the size.
+// Returns the start address, or -1 if no hole is large enough. A request
+// for nothing takes nothing and is placed at address 0, as by every fit.
+int extentFirstFit(struct ExtentTree *tree, int size)
+{
+    if (size <= 0)
+        return 0;
+    struct Extent *extent = tree->root;
+    if (extent == NULL || extent->max_length < size)
+        return -1;
+
+    // Descend towards the leftmost hole that is large enough
+    while (1)
+    {
+        if (extentMax(extent->left) >= size)
+            extent = extent->left;
+        else if (extent->length >= size)
+            break;
+        else
+            extent = extent->right;
+    }
+
+    return takeExtent(tree, extent, size);
+}
+
+// Function to take the smallest hole that fits the size, the
+// lowest-addressed one among equals.
+// Returns the start address, or -1 if no hole is large enough.
+int extentBestFit(struct ExtentTree *tree, int size)
+{
+    if (size <= 0)
+        return 0;
+    struct Extent *best = NULL;
+    for (struct Extent *extent = tree->size_root; extent != NULL;)
+    {
+        if (extent->length >= size)
+        {
+            best = extent;
+            extent = extent->size_left;
+        }
+        else
+            extent = extent->size_right;
+    }
+    return best == NULL ? -1 : takeExtent(tree, best, size);
+}
+
+// Function to take the first hole that fits the size at or after the
+// cursor, wrapping round to the start of the memory, and move the cursor
+// past it. Returns the start address, or -1 if no hole is large enough.
+int extentNextFit(struct ExtentTree *tree, int *cursor, int size)
+{
+    if (size <= 0)
+        return 0;
+    struct Extent *extent = findExtentFrom(tree->root, *cursor, size);
+    if (extent == NULL)
+        extent = findExtentFrom(tree->root, 0, size);
+    if (extent == NULL)
+        return -1;
+    int start = takeExtent(tree, extent, size);
+    *cursor = start + size;
+    return start;
+}
+
+// Function to return a range to the tree, coalescing it with the
+// neighbouring holes on either side. An empty range changes nothing.
+void extentFree(struct ExtentTree *tree, int start, int size)
+{
+    if (size <= 0)
+        return;
+    struct Extent *before, *after, *neighbour;
+    splitExtents(tree->root, start, &before, &after);
+
+    // Coalesce with the hole that ends exactly where this range starts
+    neighbour = before;
+    while (neighbour != NULL && neighbour->right != NULL)
+        neighbour = neighbour->right;
+    if (neighbour != NULL && neighbour->start + neighbour->length == start)
+    {
+        struct Extent *rest;
+        splitExtents(before, neighbour->start, &before, &rest);
+        removeExtentSize(tree, rest);
+        start = neighbour->start;
+        size += neighbour->length;
+        free(rest);
+    }
+
+    // Coalesce with the hole that starts exactly where this range ends
+    neighbour = after;
+    while (neighbour != NULL && neighbour->left != NULL)
+        neighbour = neighbour->left;
+    if (neighbour != NULL && neighbour->start == start + size)
+    {
+        struct Extent *rest;
+        splitExtents(after, neighbour->start + 1, &rest, &after);
+        removeExtentSize(tree, rest);
+        size += neighbour->length;
+        free(rest);
+    }
+
+    struct Extent *extent = createExtent(tree, start, size);
+    insertExtentSize(tree, extent);
+    tree->root = mergeExtents(mergeExtents(before, extent), after);
+}
+
+// Function to get the size of the largest hole
+int extentLargest(struct ExtentTree *tree)
+{
+    return extentMax(tree->root);
+}
+
+// Function to get the total size of the holes
+int extentFreeTotal(struct ExtentTree *tree)
+{
+    return tree->free_total;
+}
+
+// Function to check whether any hole overlaps the range
+int extentOverlaps(struct ExtentTree *tree, int start, int size)
+{
+    if (size <= 0)
+        return 0;
+    struct Extent *extent = tree->root;
+    while (extent != NULL)
+    {
+        if (extent->start >= start + size)
+            extent = extent->left;
+        else if (extent->start + extent->length <= start)
+            extent = extent->right;
+        else
+            return 1;
+    }
+    return 0;
+}
+
+void freeExtents(struct Extent *extent)
+{
+    if (extent == NULL)
+        return;
+    freeExtents(extent->left);
+    freeExtents(extent->right);
+    free(extent);
+}
+
+// Function to free the tree and every extent in it
+void freeExtentTree(struct ExtentTree *tree)
+{
+    freeExtents(tree->root);
+    free(tree);
+}
+
+void saveExtents(struct Snapshot *snapshot, struct Extent *extent)
+{
+    if (extent == NULL)
+        return;
+    saveExtents(snapshot, extent->left);
+    writeSnapshotInt(snapshot, extent->start);
+    writeSnapshotInt(snapshot, extent->length);
+    saveExtents(snapshot, extent->right);
+}
+
+int countExtents(struct Extent *extent)
+{
+    return extent == NULL ? 0 : 1 + countExtents(extent->left) + countExtents(extent->right);
+}
+
+// Function to write the holes of the tree in address order
+void saveExtentTree(struct Snapshot *snapshot, struct ExtentTree *tree)
+{
+    writeSnapshotInt(snapshot, countExtents(tree->root));
+    saveExtents(snapshot, tree->root);
+}
+
+// Function to replace the holes of the tree with those written by
+// saveExtentTree(). Holes must be in order, apart and inside the memory.
+void restoreExtentTree(struct Snapshot *snapshot, struct ExtentTree *tree, int memory_size)
+{
+    freeExtents(tree->root);
+    tree->root = tree->size_root = NULL;
+    tree->free_total = 0;
+
+    int count = readSnapshotRange(snapshot, 0, memory_size);
+    int end = -1;
+    for (int i = 0; i < count && !snapshot->failed; i++)
+    {
+        int start = readSnapshotRange(snapshot, end + 1, memory_size - 1);
+        int length = readSnapshotRange(snapshot, 1, memory_size - start);
+        if (snapshot->failed)
+            break;
+        struct Extent *extent = createExtent(tree, start, length);
+        insertExtentSize(tree, extent);
+        tree->root = mergeExtents(tree->root, extent);
+        end = start + length;
+    }
+}
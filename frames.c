@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FRAME_WORD_BITS 64
+
+// Define a structure to represent the frame table as a bitmap, with a set
+// bit for every allocated frame and a running count of free frames
+struct FrameTable
+{
+    uint64_t *words;     // One bit per frame, lowest frame in the lowest bit
+    int word_count;      // Number of 64-bit words in the bitmap
+    int first_free_word; // Every word before this one is fully allocated
+    int frame_count;     // Total number of frames
+    int free_count;      // Number of frames that are not allocated
+};
+
+// Function to create a frame table with every frame free
+struct FrameTable *createFrameTable(int frame_count)
+{
+    struct FrameTable *table = (struct FrameTable *)malloc(sizeof(struct FrameTable));
+    if (table == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    table->word_count = (frame_count + FRAME_WORD_BITS - 1) / FRAME_WORD_BITS;
+    table->words = (uint64_t *)calloc(table->word_count > 0 ? table->word_count : 1, sizeof(uint64_t));
+    if (table->words == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    table->first_free_word = 0;
+    table->frame_count = frame_count;
+    table->free_count = frame_count;
+
+    // Mark the bits past the last frame as allocated so scans never return them
+    if (frame_count % FRAME_WORD_BITS != 0)
+        table->words[table->word_count - 1] = ~(uint64_t)0 << (frame_count % FRAME_WORD_BITS);
+    return table;
+}
+
+// Function to check whether a frame is allocated
+int frameIsUsed(struct FrameTable *table, int frame)
+{
+    if (frame < 0 || frame >= table->frame_count)
+        return 0;
+    return (table->words[frame / FRAME_WORD_BITS] >> (frame % FRAME_WORD_BITS)) & 1;
+}
+
+// Function to take a run of consecutive free frames, starting at the
+// lowest-numbered free frame and holding at most max_frames frames.
+// Returns the number of frames taken and stores the first in *start.
+int frameTakeRun(struct FrameTable *table, int max_frames, int *start)
+{
+    if (table->free_count == 0 || max_frames <= 0)
+        return 0;
+
+    int word = table->first_free_word;
+    while (~table->words[word] == 0)
+        word++;
+    table->first_free_word = word;
+    *start = word * FRAME_WORD_BITS + __builtin_ctzll(~table->words[word]);
+
+    // Claim free bits a word at a time until the run or the request ends.
+    // The padding bits past the last frame are set, so runs stop there.
+    int taken = 0;
+    int frame = *start;
+    while (taken < max_frames && frame < table->frame_count)
+    {
+        int bit = frame % FRAME_WORD_BITS;
+        uint64_t free_bits = ~table->words[frame / FRAME_WORD_BITS] >> bit;
+        int run = ~free_bits == 0 ? FRAME_WORD_BITS : __builtin_ctzll(~free_bits);
+        if (run == 0)
+            break;
+        if (run > max_frames - taken)
+            run = max_frames - taken;
+        uint64_t mask = run == FRAME_WORD_BITS ? ~(uint64_t)0 : (((uint64_t)1 << run) - 1) << bit;
+        table->words[frame / FRAME_WORD_BITS] |= mask;
+        taken += run;
+        frame += run;
+        if (bit + run < FRAME_WORD_BITS)
+            break; // The run ended inside this word
+    }
+    table->free_count -= taken;
+    return taken;
+}
+
+// Function to mark an allocated frame as free again
+void frameRelease(struct FrameTable *table, int frame)
+{
+    if (!frameIsUsed(table, frame))
+        return;
+    table->words[frame / FRAME_WORD_BITS] &= ~((uint64_t)1 << (frame % FRAME_WORD_BITS));
+    table->free_count++;
+    if (frame / FRAME_WORD_BITS < table->first_free_word)
+        table->first_free_word = frame / FRAME_WORD_BITS;
+}
+
+// Function to free the frame table
+void freeFrameTable(struct FrameTable *table)
+{
+    free(table->words);
+    free(table);
+}
+
+// Define a structure to represent a run of slots in a frame list: either
+// consecutive frame numbers starting at start, or empty slots (start -1)
+struct FrameRun
+{
+    int start;
+    int length;
+};
+
+// Define a structure to represent the frame slots of a process as runs.
+// Slot i holds the i-th frame given to the process, or nothing once that
+// frame has been evicted. Slots past the last run are empty.
+struct FrameList
+{
+    struct FrameRun *runs;
+    int count;       // Number of runs
+    int capacity;    // Number of runs allocated
+    int frame_count; // Number of slots that hold a frame
+};
+
+void insertFrameRun(struct FrameList *list, int index, int start, int length)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->runs = (struct FrameRun *)realloc(list->runs, list->capacity * sizeof(struct FrameRun));
+        if (list->runs == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memmove(&list->runs[index + 1], &list->runs[index], (list->count - index) * sizeof(struct FrameRun));
+    list->runs[index].start = start;
+    list->runs[index].length = length;
+    list->count++;
+}
+
+void removeFrameRuns(struct FrameList *list, int index, int count)
+{
+    memmove(&list->runs[index], &list->runs[index + count], (list->count - index - count) * sizeof(struct FrameRun));
+    list->count -= count;
+}
+
+// Merge the run with the one after it if they continue each other
+void joinFrameRun(struct FrameList *list, int index)
+{
+    if (index < 0 || index + 1 >= list->count)
+        return;
+    struct FrameRun *run = &list->runs[index];
+    struct FrameRun *next = &list->runs[index + 1];
+    if ((run->start == -1 && next->start == -1) ||
+        (run->start != -1 && run->start + run->length == next->start))
+    {
+        run->length += next->length;
+        removeFrameRuns(list, index + 1, 1);
+    }
+}
+
+// Return the index of the run that begins at the slot, splitting a run
+// or padding the end with empty slots so that one does
+int splitFrameRuns(struct FrameList *list, int slot)
+{
+    int position = 0;
+    for (int i = 0; i < list->count; i++)
+    {
+        if (position == slot)
+            return i;
+        struct FrameRun *run = &list->runs[i];
+        if (position + run->length > slot)
+        {
+            int head = slot - position;
+            insertFrameRun(list, i + 1, run->start == -1 ? -1 : run->start + head, run->length - head);
+            list->runs[i].length = head;
+            return i + 1;
+        }
+        position += run->length;
+    }
+    if (position < slot)
+        insertFrameRun(list, list->count, -1, slot - position);
+    return list->count;
+}
+
+// Function to put a run of frames into the slots starting at the given
+// slot, replacing whatever those slots held before
+void frameListWrite(struct FrameList *list, int slot, int start, int length)
+{
+    if (length <= 0)
+        return;
+    int first = splitFrameRuns(list, slot);
+    int last = splitFrameRuns(list, slot + length);
+    for (int i = first; i < last; i++)
+    {
+        if (list->runs[i].start != -1)
+            list->frame_count -= list->runs[i].length;
+    }
+    removeFrameRuns(list, first, last - first);
+    insertFrameRun(list, first, start, length);
+    if (start != -1)
+        list->frame_count += length;
+    joinFrameRun(list, first);
+    joinFrameRun(list, first - 1);
+}
+
+// Function to empty the first held slots, taking at most max_frames frames
+// from slots before slot_limit. Returns the number of frames taken, which
+// are consecutive and start at *start.
+int frameListTakeRun(struct FrameList *list, int max_frames, int slot_limit, int *start)
+{
+    int position = 0;
+    for (int i = 0; i < list->count && position < slot_limit; i++)
+    {
+        struct FrameRun *run = &list->runs[i];
+        if (run->start == -1)
+        {
+            position += run->length;
+            continue;
+        }
+        int taken = run->length;
+        if (taken > max_frames)
+            taken = max_frames;
+        if (taken > slot_limit - position)
+            taken = slot_limit - position;
+        if (taken <= 0)
+            return 0;
+
+        *start = run->start;
+        if (taken == run->length)
+            run->start = -1;
+        else
+        {
+            run->start += taken;
+            run->length -= taken;
+            insertFrameRun(list, i, -1, taken);
+        }
+        list->frame_count -= taken;
+        joinFrameRun(list, i);
+        joinFrameRun(list, i - 1);
+        return taken;
+    }
+    return 0;
+}
+
+// Function to find the first empty slot before slot_limit. Returns the
+// slot, or -1 if every slot is held, and stores in *length how many empty
+// slots start there.
+int frameListFirstEmpty(struct FrameList *list, int slot_limit, int *length)
+{
+    int position = 0;
+    for (int i = 0; i < list->count && position < slot_limit; i++)
+    {
+        struct FrameRun *run = &list->runs[i];
+        if (run->start == -1)
+        {
+            *length = run->length < slot_limit - position ? run->length : slot_limit - position;
+            return position;
+        }
+        position += run->length;
+    }
+    if (position >= slot_limit)
+        return -1;
+    *length = slot_limit - position;
+    return position;
+}
+
+// Function to release the run array of the list
+void freeFrameList(struct FrameList *list)
+{
+    free(list->runs);
+    list->runs = NULL;
+    list->count = list->capacity = list->frame_count = 0;
+}
+
+// Function to write the allocated frames of the table
+void saveFrameTable(struct Snapshot *snapshot, struct FrameTable *table)
+{
+    writeSnapshotArray(snapshot, table->words, table->word_count, sizeof(uint64_t));
+    writeSnapshotInt(snapshot, table->first_free_word);
+    writeSnapshotInt(snapshot, table->free_count);
+}
+
+// Function to overwrite a table of the same size with the frames written
+// by saveFrameTable(). The padding bits past the last frame must be set,
+// the free count must match the bitmap and no word before first_free_word
+// may have a free frame, or scans would run past the end of the table.
+void restoreFrameTable(struct Snapshot *snapshot, struct FrameTable *table)
+{
+    readSnapshotArray(snapshot, table->words, table->word_count, sizeof(uint64_t));
+    table->first_free_word = readSnapshotRange(snapshot, 0, table->word_count);
+    table->free_count = readSnapshotRange(snapshot, 0, table->frame_count);
+    if (snapshot->failed)
+        return;
+
+    if (table->frame_count % FRAME_WORD_BITS != 0)
+    {
+        uint64_t padding = ~(uint64_t)0 << (table->frame_count % FRAME_WORD_BITS);
+        if ((table->words[table->word_count - 1] & padding) != padding)
+            snapshot->failed = 1;
+    }
+    int free_count = 0;
+    int first_free_word = table->word_count;
+    for (int i = 0; i < table->word_count; i++)
+    {
+        int free_bits = FRAME_WORD_BITS - __builtin_popcountll(table->words[i]);
+        if (free_bits > 0 && first_free_word == table->word_count)
+            first_free_word = i;
+        free_count += free_bits;
+    }
+    if (free_count != table->free_count || table->first_free_word > first_free_word)
+        snapshot->failed = 1;
+}
+
+// Function to write the runs of a frame list
+void saveFrameList(struct Snapshot *snapshot, struct FrameList *list)
+{
+    writeSnapshotArray(snapshot, list->runs, list->count, sizeof(struct FrameRun));
+    writeSnapshotInt(snapshot, list->frame_count);
+}
+
+// Function to read the runs written by saveFrameList() into an empty list.
+// Every run must be a range of frames below frame_count, or empty slots.
+void restoreFrameList(struct Snapshot *snapshot, struct FrameList *list, int frame_count)
+{
+    int count = readSnapshotRange(snapshot, 0, 2 * frame_count + 1); // Held runs alternate with empty ones at worst
+    list->runs = NULL;
+    list->count = list->capacity = list->frame_count = 0;
+    if (count > 0)
+    {
+        list->runs = (struct FrameRun *)malloc(count * sizeof(struct FrameRun));
+        if (list->runs == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        list->capacity = count;
+    }
+    readSnapshot(snapshot, list->runs, count * sizeof(struct FrameRun));
+    list->count = count;
+    for (int i = 0; i < count; i++)
+    {
+        struct FrameRun *run = &list->runs[i];
+        if (run->length <= 0 || run->start < -1 || (run->start != -1 && run->length > frame_count - run->start))
+            snapshot->failed = 1;
+    }
+    list->frame_count = readSnapshotRange(snapshot, 0, frame_count);
+}
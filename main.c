@@ -1,870 +1,571 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <string.h>
-#include <math.h>
-#include "queue.c"
-
-#define MAX_LINE_LENGTH 100
-#define MEMORY_SIZE 2048
-#define PAGE_NUM 512
-#define IS_VIRTUAL 1
-#define NOT_VIRTUAL 0
-
-typedef enum
+#include <pthread.h>
+#include "sched.h"
+
+#define OPT_FRAMES 256 // Long-only option ids start past any short option character
+#define OPT_SWEEP 257
+#define OPT_CHECKPOINT_EVERY 258
+#define OPT_CHECKPOINT_PREFIX 259
+#define OPT_RESTORE 260
+#define OPT_PERCENTILES 261
+#define OPT_METRICS 262
+#define OPT_METRICS_EVERY 263
+#define OPT_METRICS_FORMAT 264
+#define OPT_MIGRATION_COST 265
+#define OPT_NODES 266
+#define OPT_NUMA_POLICY 267
+#define OPT_REMOTE_COST 268
+#define OPT_FAULT_COST 269
+#define OPT_WRITEBACK_COST 270
+#define OPT_SWITCH_COST 271
+#define OPT_REFERENCES 272
+#define OPT_REFERENCES_FILE 273
+#define OPT_REFERENCE_RATE 274
+#define OPT_TLB_ENTRIES 275
+#define OPT_TLB_WAYS 276
+
+// Define a structure to represent one run of a sweep and its summary
+struct SweepJob
 {
-    UNREADY,
-    READY,
-    RUNNING,
-    FINISHED
-} ProcessStatus;
-
-typedef struct Process
+    int quantum;
+    const char *memory_strategy;
+    sched_ctx *ctx;
+    int failed; // 1 if the run did not finish, leaving result unset
+    struct sched_result result;
+};
+
+// Define a structure to represent a parameter sweep (--sweep). Every pair
+// of a listed quantum and memory strategy is run as its own simulation on
+// a pool of threads; the trace is read once and shared by all of them.
+struct Sweep
 {
-    char pid;
-    char *name;                        // Process Name
-    int arrival_time;                  // Arrival time
-    int remaining_time;                // Remaining execution time
-    ProcessStatus status;              // Status of the process
-    int memory_executed_proc_arr_size; // Required memory usage in KB
-    int memory_start_address;          // Indicate the start adress of the memory; -1 if the memory is not allocated
-    int frames[PAGE_NUM];
-    int total_page;
-    int sum_remaining_time;
-    int total_time;
-} Process;
-
-typedef struct
+    int enabled;
+    int *quanta;
+    int quantum_count;
+    char **strategies;
+    int strategy_count;
+    sched_trace *trace;
+    struct SweepJob *jobs;
+    int job_count;
+    int next_job;         // First job no worker has taken yet
+    pthread_mutex_t lock; // Guards next_job
+};
+
+// Define a structure to represent the snapshots of a single run
+struct Checkpoints
 {
-    int memory_blocks[MEMORY_SIZE]; // An array of blocks in the memory with 0 representing empty blocks and 1 representing allocated blocks
-} ContiguousMemory;
+    int every;           // Simulated time between snapshots, 0 for none
+    const char *prefix;  // Snapshots are written to <prefix><time>.snap
+    const char *restore; // Snapshot to resume from, NULL to start afresh
+};
 
 char *filename = NULL;
-char *memory_strategy = NULL;
-int quantum_time = -1;
-int current_time = 0;
-int process_count = 0;
-int memory_usage = 0;
-int memory_array[MEMORY_SIZE] = {0};
-int page_array[PAGE_NUM] = {0}; // page total number
-int total_turnovertime;
-int total_process;
-int make_span;
-int total_turnover;
-struct Queue *unready_processes;
-struct Queue *ready_processes;
-double overhead_array[100];
-
-ContiguousMemory contiguousMemory;
-Process **executed_proc_arr;    // Array that monitors the order in which processes are executed
-int executed_proc_arr_capacity; // Maximum capacity of the  array
-int executed_proc_arr_size;     // Number of elements in the array
-int executed_proc_arr_front;    // Index of the front of the array
-int executed_proc_arr_rear;     // Index of the rear of the array
-
-int tryAllocateMemory(Process *process, struct Queue *queue_ready);
-int tryFreeMemory(Process *process);
-
-void initialiseExecutedProcArr(int executed_proc_arr_capacity);
-void addToExecutedProcArr(Process *process);
-void removeFnishedProcFromArr();
-Process *getEvictProcess();
-
-int initialiseContiguousMemory();
-int alllocateContiguousMemory(int executed_proc_arr_size);
-void freeContiguousMemory(int start_address, int executed_proc_arr_size);
-
-int allocatePagedMemory(struct Process *process, struct Queue *queue_ready, int virtual_status);
-void freePagedMemory(Process *process);
-int allocateVirtualMemory(Process *pProcess, struct Queue *pQueue);
-int sumPageLeft();
-void evictPage(int num_frame, int virtual_status);
-int fitAllPage(Process *process, int frame_needed);
-void printMemoryFrames(Process *process, int num_page);
-int getPagedMemoryUsage();
-
-int singleTurnoverTime(int service_time, int current_time);
-void calculateTurnoverTime(int end_time, int start_time);
-void calculateAverageTurnover(int total_turnovertime, int total_process);
-void calculateMakeSpan(int time);
-double calculateTimeOverhead(int turnaround_time, int service_time);
-void printOverhead();
+const char *metrics_name = NULL; // Time series file (--metrics), NULL for none
+struct sched_config options;
+struct Sweep sweep;
+struct Checkpoints checkpoints = {0, "checkpoint-", NULL};
 
 int parse(int argc, char *argv[]);
-int readInput();
-int schedule();
-void cleanUp();
+void *resizeArray(void *array, size_t count, size_t size);
+void addSweepQuantum(int quantum);
+void addSweepStrategy(const char *memory_strategy);
+int parseSweepSpec(const char *spec);
+void *runSweepJobs(void *unused);
+int createSweepJobs();
+int runSweep();
+int writeCheckpoint(sched_ctx *ctx);
+int restoreCheckpoint(sched_ctx *ctx);
+int runSimulation(sched_ctx *ctx);
 
 int main(int argc, char *argv[])
 {
-    parse(argc, argv);
-    readInput();
-    initialiseExecutedProcArr(process_count + 1); // initialise the array that tracks the order of the executed process
-    schedule();
-    cleanUp();
-    return 0;
-}
-
-int tryAllocateMemory(Process *process, struct Queue *queue_ready)
-{
-    // Memory has already been allocated for the process
-    if (process->memory_start_address != -1)
-        return 1;
-
-    // Allocation is not needed
-    if (strcmp(memory_strategy, "infinite") == 0)
+    // allocate convert <text trace> <binary trace>
+    if (argc >= 2 && strcmp(argv[1], "convert") == 0)
     {
-        return 1;
-    }
-
-    if (strcmp(memory_strategy, "first-fit") == 0)
-    {
-        int start_address = alllocateContiguousMemory(process->memory_executed_proc_arr_size);
-        if (start_address != -1)
+        if (argc != 4)
         {
-            process->memory_start_address = start_address;
+            fprintf(stderr, "Usage: %s convert <text trace> <binary trace>\n", argv[0]);
             return 1;
         }
-        return 0;
+        return sched_convert_trace(argv[2], argv[3]);
     }
 
-    if (strcmp(memory_strategy, "paged") == 0)
+    if (parse(argc, argv) != 0)
+        return 1;
+    if (sweep.enabled)
+        return runSweep();
+
+    if (metrics_name != NULL)
     {
-        if (process->total_page == 0)
+        options.metrics_fd = open(metrics_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (options.metrics_fd < 0)
         {
-            // If no pages have been allocated yet
-            allocatePagedMemory(process, queue_ready, NOT_VIRTUAL);
+            perror("Error opening metrics file");
+            return 1;
         }
-        return 1; // Assuming allocatePagedMemory is correctly defined elsewhere
-    }
-    if (strcmp(memory_strategy, "virtual") == 0 && process->total_page == 0)
-    {
-        // If no pages have been allocated yet
-        allocateVirtualMemory(process, queue_ready);
-    }
-
-    return 1;
-}
-
-int tryFreeMemory(Process *process)
-{
-    if (strcmp(memory_strategy, "infinite") == 0)
-    {
-        return 0; // Returns success as freeing memory is not needed
-    }
-
-    if (strcmp(memory_strategy, "first-fit") == 0)
-    {
-        freeContiguousMemory(process->memory_start_address, process->memory_executed_proc_arr_size);
-        return 0;
-    }
-    if (strcmp(memory_strategy, "paged") == 0)
-    {
-        freePagedMemory(process);
-        return 0;
     }
-    if (strcmp(memory_strategy, "virtual") == 0)
+    sched_ctx *ctx = sched_create(&options);
+    int failed = ctx == NULL || sched_load(ctx, filename) != 0 ||
+                 (checkpoints.restore != NULL && restoreCheckpoint(ctx) != 0) ||
+                 runSimulation(ctx) != 0;
+    if (ctx != NULL)
+        sched_destroy(ctx);
+    if (options.metrics_fd >= 0 && close(options.metrics_fd) != 0)
     {
-        freePagedMemory(process);
-        return 0;
+        perror("Error writing metrics file");
+        failed = 1;
     }
-
-    return 0;
-}
-
-// Initialize process manager with a specified executed_proc_arr_capacity
-void initialiseExecutedProcArr(int max_process)
-{
-    executed_proc_arr_capacity = max_process;
-    executed_proc_arr_size = 0;
-    executed_proc_arr_front = 0;
-    executed_proc_arr_rear = -1;
-    executed_proc_arr = (Process **)malloc(executed_proc_arr_capacity * sizeof(Process *));
+    return failed;
 }
 
-// Add or move the executed process to the end of the array if it's not already in the array
-void addToExecutedProcArr(Process *process)
+int parse(int argc, char *argv[])
 {
-    // Check if the process is already in the executed_process array
-    for (int i = executed_proc_arr_front; i != (executed_proc_arr_rear + 1) % executed_proc_arr_capacity; i = (i + 1) % executed_proc_arr_capacity)
+    static struct option long_options[] = {
+        {"frames", required_argument, NULL, OPT_FRAMES},
+        {"sweep", required_argument, NULL, OPT_SWEEP},
+        {"checkpoint-every", required_argument, NULL, OPT_CHECKPOINT_EVERY},
+        {"checkpoint-prefix", required_argument, NULL, OPT_CHECKPOINT_PREFIX},
+        {"restore", required_argument, NULL, OPT_RESTORE},
+        {"percentiles", no_argument, NULL, OPT_PERCENTILES},
+        {"metrics", required_argument, NULL, OPT_METRICS},
+        {"metrics-every", required_argument, NULL, OPT_METRICS_EVERY},
+        {"metrics-format", required_argument, NULL, OPT_METRICS_FORMAT},
+        {"migration-cost", required_argument, NULL, OPT_MIGRATION_COST},
+        {"nodes", required_argument, NULL, OPT_NODES},
+        {"numa-policy", required_argument, NULL, OPT_NUMA_POLICY},
+        {"remote-cost", required_argument, NULL, OPT_REMOTE_COST},
+        {"fault-cost", required_argument, NULL, OPT_FAULT_COST},
+        {"writeback-cost", required_argument, NULL, OPT_WRITEBACK_COST},
+        {"switch-cost", required_argument, NULL, OPT_SWITCH_COST},
+        {"references", required_argument, NULL, OPT_REFERENCES},
+        {"references-file", required_argument, NULL, OPT_REFERENCES_FILE},
+        {"reference-rate", required_argument, NULL, OPT_REFERENCE_RATE},
+        {"tlb-entries", required_argument, NULL, OPT_TLB_ENTRIES},
+        {"tlb-ways", required_argument, NULL, OPT_TLB_WAYS},
+        {NULL, 0, NULL, 0}};
+
+    sched_default_config(&options);
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:m:q:M:P:s:S:r:c:", long_options, NULL)) != -1)
     {
-        if (executed_proc_arr[i]->pid == process->pid)
+        switch (opt)
         {
-            // Process found in the executed_proc_arr, remove it
-            for (int j = i; j != executed_proc_arr_rear; j = (j + 1) % executed_proc_arr_capacity)
+        case 'f':
+            filename = optarg;
+            break;
+        case 'm':
+            options.memory_strategy = optarg;
+            break;
+        case 'q':
+            options.quantum = atoi(optarg);
+            break;
+        case 'M':
+            options.memory_size = atoi(optarg);
+            break;
+        case 'P':
+            options.page_size = atoi(optarg);
+            break;
+        case 's':
+            options.scheduler_policy = optarg;
+            break;
+        case 'r':
+            options.replacement_policy = optarg;
+            break;
+        case 'S':
+            options.seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'c':
+            options.core_count = atoi(optarg);
+            break;
+        case OPT_MIGRATION_COST:
+            options.migration_cost = atoi(optarg);
+            break;
+        case OPT_NODES:
+            options.node_count = atoi(optarg);
+            break;
+        case OPT_NUMA_POLICY:
+            options.numa_policy = optarg;
+            break;
+        case OPT_REMOTE_COST:
+            options.remote_cost = atoi(optarg);
+            break;
+        case OPT_FAULT_COST:
+            options.fault_cost = atoi(optarg);
+            break;
+        case OPT_WRITEBACK_COST:
+            options.writeback_cost = atoi(optarg);
+            break;
+        case OPT_SWITCH_COST:
+            options.switch_cost = atoi(optarg);
+            break;
+        case OPT_REFERENCES:
+            options.references = optarg;
+            break;
+        case OPT_REFERENCES_FILE:
+            options.references_file = optarg;
+            break;
+        case OPT_REFERENCE_RATE:
+            options.reference_rate = atoi(optarg);
+            break;
+        case OPT_TLB_ENTRIES:
+            options.tlb_entries = atoi(optarg);
+            break;
+        case OPT_TLB_WAYS:
+            options.tlb_ways = atoi(optarg);
+            break;
+        case OPT_FRAMES:
+            if (strcmp(optarg, "ranges") == 0)
+                options.frames_as_ranges = 1;
+            else if (strcmp(optarg, "list") == 0)
+                options.frames_as_ranges = 0;
+            else
             {
-                // Shift elements to the left to fill the gap
-                executed_proc_arr[j] = executed_proc_arr[(j + 1) % executed_proc_arr_capacity];
+                fprintf(stderr, "--frames must be list or ranges\n");
+                return 1;
             }
-            executed_proc_arr_rear = (executed_proc_arr_rear - 1 + executed_proc_arr_capacity) % executed_proc_arr_capacity; // Update executed_proc_arr_rear index
-            executed_proc_arr_size--;                                                                                        // Update executed_proc_arr_size
             break;
-        }
-    }
-    // Add the process to the end of the executed_proc_arr if it's not already in the executed_proc_arr
-    if (executed_proc_arr_size >= executed_proc_arr_capacity)
-    {
-        fprintf(stderr, "executed_proc_arr is full. Cannot add more processes.\n");
-        return;
-    }
-    executed_proc_arr_rear = (executed_proc_arr_rear + 1) % executed_proc_arr_capacity;
-    executed_proc_arr[executed_proc_arr_rear] = process;
-    executed_proc_arr_size++;
-}
-
-void removeFnishedProcFromArr()
-{
-    for (int i = executed_proc_arr_front; i != (executed_proc_arr_rear + 1) % executed_proc_arr_capacity; i = (i + 1) % executed_proc_arr_capacity)
-    {
-        if (executed_proc_arr[i]->status == FINISHED)
-        {
-            // Process found in the executed_proc_arr, remove it
-            for (int j = i; j != executed_proc_arr_rear; j = (j + 1) % executed_proc_arr_capacity)
+        case OPT_SWEEP:
+            sweep.enabled = 1;
+            if (parseSweepSpec(optarg) != 0)
+                return 1;
+            break;
+        case OPT_CHECKPOINT_EVERY:
+            checkpoints.every = atoi(optarg);
+            if (checkpoints.every <= 0)
             {
-                // Shift elements to the left to fill the gap
-                executed_proc_arr[j] = executed_proc_arr[(j + 1) % executed_proc_arr_capacity];
+                fprintf(stderr, "--checkpoint-every must be positive\n");
+                return 1;
             }
-            executed_proc_arr_rear = (executed_proc_arr_rear - 1 + executed_proc_arr_capacity) % executed_proc_arr_capacity; // Update executed_proc_arr_rear index
-            executed_proc_arr_size--;                                                                                        // Update executed_proc_arr_size
             break;
-        }
-    }
-}
-
-// Select and remove the least recently executed process
-Process *getEvictProcess()
-{
-    Process *process_to_evict;
-    while (1)
-    {
-        if (executed_proc_arr_size == 0)
-        {
-            return NULL; // Queue is empty
-        }
-        process_to_evict = executed_proc_arr[executed_proc_arr_front];
-
-        if (process_to_evict->total_page <= 0)
-        {
-            // If no page is available for this process,
-            // remove it from the array and move to the next process
-            executed_proc_arr_front = (executed_proc_arr_front + 1) % executed_proc_arr_capacity;
-            executed_proc_arr_size--;
-            continue;
-        }
-        else
-        {
-            // If the process have page to be evicted, terminates and returns
+        case OPT_CHECKPOINT_PREFIX:
+            checkpoints.prefix = optarg;
             break;
-        }
-    }
-    return process_to_evict;
-}
-
-int initialiseContiguousMemory()
-{
-    for (int i = 0; i < MEMORY_SIZE - 1; i++)
-    {
-        contiguousMemory.memory_blocks[i] = 0; // Initialise all blocks to be empty
-    }
-
-    return 0;
-}
-
-int alllocateContiguousMemory(int executed_proc_arr_size)
-{
-    int start_address = -1;
-
-    for (int i = 0; i < MEMORY_SIZE - executed_proc_arr_size + 1; i++)
-    {
-        for (int j = i; j < i + executed_proc_arr_size; j++)
-        {
-            if (contiguousMemory.memory_blocks[j] == 1)
+        case OPT_RESTORE:
+            checkpoints.restore = optarg;
+            break;
+        case OPT_PERCENTILES:
+            options.report_percentiles = 1;
+            break;
+        case OPT_METRICS:
+            metrics_name = optarg;
+            break;
+        case OPT_METRICS_EVERY:
+            options.metrics_every = atoi(optarg);
+            if (options.metrics_every <= 0)
             {
-                break;
+                fprintf(stderr, "--metrics-every must be positive\n");
+                return 1;
             }
-            if (j == i + executed_proc_arr_size - 1 && contiguousMemory.memory_blocks[j] == 0)
+            break;
+        case OPT_METRICS_FORMAT:
+            if (strcmp(optarg, "binary") == 0)
+                options.metrics_binary = 1;
+            else if (strcmp(optarg, "csv") == 0)
+                options.metrics_binary = 0;
+            else
             {
-                start_address = i;
-                break;
+                fprintf(stderr, "--metrics-format must be csv or binary\n");
+                return 1;
             }
-        }
-
-        if (start_address != -1)
             break;
+        default:
+            perror("Error reading command line parameters");
+            return 1;
+        }
     }
 
-    // Allocate the memory blocks for the process if there exists an available hole
-    if (start_address != -1)
+    // The settings of a sweep may be split over several words,
+    // as in --sweep q=1..10 m=first-fit,paged
+    for (; sweep.enabled && optind < argc; optind++)
     {
-        for (int i = start_address; i < start_address + executed_proc_arr_size; i++)
-        {
-            contiguousMemory.memory_blocks[i] = 1;
-        }
-        memory_usage += executed_proc_arr_size; // Add to the total memory used count
+        if (parseSweepSpec(argv[optind]) != 0)
+            return 1;
     }
-
-    return start_address; // Returns -1 if the allocation fails; returns the start address if the allocation is successful
-}
-
-void freeContiguousMemory(int start_address, int executed_proc_arr_size)
-{
-    for (int i = start_address; i < start_address + executed_proc_arr_size; i++)
+    if (optind < argc)
     {
-        contiguousMemory.memory_blocks[i] = 0;
+        fprintf(stderr, "Unexpected argument %s\n", argv[optind]);
+        return 1;
     }
+    if (sweep.enabled && sweep.quantum_count == 0)
+        addSweepQuantum(options.quantum);
+    if (sweep.enabled && sweep.strategy_count == 0 && options.memory_strategy != NULL)
+        addSweepStrategy(options.memory_strategy);
 
-    memory_usage -= executed_proc_arr_size; // Reduce from the total memory used count
-}
-
-int allocatePagedMemory(struct Process *process, struct Queue *queue_ready, int virtual_status)
-{
-    int total_frame = ceil(process->memory_executed_proc_arr_size / 4.0);
-
-    int page_left = sumPageLeft(page_array);
-    if (virtual_status == NOT_VIRTUAL)
+    if (options.memory_strategy == NULL && sweep.strategy_count == 0)
     {
-        process->total_page = total_frame;
-        if (page_left < total_frame && virtual_status == NOT_VIRTUAL)
-        {
-            evictPage(total_frame, virtual_status);
-        }
-        fitAllPage(process, total_frame);
+        fprintf(stderr, "A memory strategy must be given with -m\n");
+        return 1;
     }
-
-    if (virtual_status == IS_VIRTUAL)
+    if (sweep.enabled && (checkpoints.every > 0 || checkpoints.restore != NULL))
     {
-        int frame_needed = total_frame - process->total_page;
-        if (page_left + process->total_page < 4)
-        {
-            if (frame_needed > 4)
-            {
-                frame_needed = 4;
-            }
-
-            int evict_frames = frame_needed - page_left - process->total_page;
-            evictPage(evict_frames, IS_VIRTUAL);
-        }
-        int counter = 0;
-        for (int i = 0; i < PAGE_NUM; i++)
-        {
-            if (page_array[i] == 0)
-            {
-                process->frames[counter] = i;
-                process->total_page += 1;
-                page_array[i] = 1;
-                counter++;
-            }
-            if (counter == frame_needed)
-            {
-                break;
-            }
-        }
+        fprintf(stderr, "--checkpoint-every and --restore apply to a single run, not to --sweep\n");
+        return 1;
+    }
+    if (sweep.enabled && metrics_name != NULL)
+    {
+        fprintf(stderr, "--metrics applies to a single run, not to --sweep\n");
+        return 1;
     }
-
     return 0;
 }
 
-void freePagedMemory(Process *process)
+void *resizeArray(void *array, size_t count, size_t size)
 {
-    printf("%d,EVICTED,evicted-frames=[", current_time);
-    int first = 1;
-
-    for (int i = 0; i < process->total_page; i++)
+    void *resized = realloc(array, count * size);
+    if (resized == NULL)
     {
-        int pageIndex = process->frames[i];
-        if (pageIndex != -1)
-        { // Assuming -1 indicates an unused slot in the frames array
-            if (!first)
-                printf(",");
-            printf("%d", pageIndex);
-            first = 0;
-            page_array[pageIndex] = 0; // Mark the page as free
-            process->frames[i] = -1;
-        }
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
     }
-    process->total_page = 0; // Reset the total_page count for the process
-    printf("]\n");
+    return resized;
 }
 
-int allocateVirtualMemory(Process *pProcess, struct Queue *pQueue)
+void addSweepQuantum(int quantum)
 {
-    int total_frame = ceil(pProcess->memory_executed_proc_arr_size / 4.0);
-
-    int page_left = sumPageLeft(page_array);
-    if (total_frame > page_left)
-    {
-        allocatePagedMemory(pProcess, pQueue, IS_VIRTUAL);
-        return 0;
-    }
-    if (total_frame >= 4 && total_frame <= page_left)
-    {
-        allocatePagedMemory(pProcess, pQueue, IS_VIRTUAL);
-    }
-    return 0;
+    sweep.quanta = resizeArray(sweep.quanta, sweep.quantum_count + 1, sizeof(int));
+    sweep.quanta[sweep.quantum_count++] = quantum;
 }
 
-int sumPageLeft()
+void addSweepStrategy(const char *memory_strategy)
 {
-    int count = 0;
-    for (int i = 0; i < PAGE_NUM; i++)
+    sweep.strategies = resizeArray(sweep.strategies, sweep.strategy_count + 1, sizeof(*sweep.strategies));
+    sweep.strategies[sweep.strategy_count] = strdup(memory_strategy);
+    if (sweep.strategies[sweep.strategy_count] == NULL)
     {
-        if (page_array[i] == 0)
-        {
-            count++;
-        }
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
     }
-    return count;
+    sweep.strategy_count++;
 }
 
-void evictPage(int num_frame, int virtual_status)
+// Function to read one sweep setting: "q=" followed by quanta and ranges
+// of quanta such as 1..10, or "m=" followed by memory strategies, each
+// list separated by commas. Returns 0 on success.
+int parseSweepSpec(const char *spec)
 {
-    printf("%d,EVICTED,evicted-frames=[", current_time);
-    int first = 1;
-    int initial_free_pages = sumPageLeft();
-
-    int num_evict = 0;
-    while (initial_free_pages < num_frame)
+    int is_quanta = strncmp(spec, "q=", 2) == 0;
+    if (!is_quanta && strncmp(spec, "m=", 2) != 0)
     {
-        struct Process *top_process = getEvictProcess();
-
-        if (top_process == NULL)
-        {
-            continue;
-        }
-
-        if (top_process->status == FINISHED)
-        {
-            continue;
-        }
+        fprintf(stderr, "Unknown sweep setting %s, expected q=... or m=...\n", spec);
+        return 1;
+    }
 
-        if (virtual_status == IS_VIRTUAL)
-        {
-            num_evict = num_frame;
-        }
-        if (virtual_status == NOT_VIRTUAL)
+    const char *item = spec + 2;
+    while (1)
+    {
+        size_t length = strcspn(item, ",");
+        char value[64];
+        if (length == 0 || length >= sizeof(value))
         {
-            num_evict = top_process->total_page;
+            fprintf(stderr, "Malformed sweep setting %s\n", spec);
+            return 1;
         }
-        int evicted_frames = 0;
-
-        for (int i = 0; i < sizeof(top_process->frames); i++)
-        {
-            int index = top_process->frames[i];
-
-            if (index == -1 || page_array[index] != 1)
-                continue;
+        memcpy(value, item, length);
+        value[length] = '\0';
 
-            if (!first)
-            {
-                printf(",");
-            }
-
-            printf("%d", index);
-            first = 0;
-            page_array[index] = 0;       // Mark the page as free
-            top_process->frames[i] = -1; // Clear the frame entry
-            evicted_frames++;
-
-            if (evicted_frames == num_evict)
-                break;
-        }
-        initial_free_pages = num_frame + initial_free_pages;
-        if (virtual_status == IS_VIRTUAL)
+        int first, last, used = 0;
+        if (!is_quanta)
+            addSweepStrategy(value); // Checked when the runs are created
+        else if (sscanf(value, "%d..%d%n", &first, &last, &used) == 2 && value[used] == '\0')
         {
-            int left_frame = top_process->total_page - num_frame;
-            if (left_frame <= 0)
+            if (first > last)
             {
-                top_process->total_page = 0;
+                fprintf(stderr, "Empty sweep range %s\n", value);
+                return 1;
             }
+            for (int quantum = first; quantum <= last; quantum++)
+                addSweepQuantum(quantum);
         }
-        if (virtual_status == NOT_VIRTUAL)
+        else if (sscanf(value, "%d%n", &first, &used) == 1 && value[used] == '\0')
+            addSweepQuantum(first);
+        else
         {
-            top_process->total_page = 0;
+            fprintf(stderr, "Malformed sweep quantum %s\n", value);
+            return 1;
         }
-    }
-
-    printf("]\n");
-}
 
-int fitAllPage(Process *process, int frame_needed)
-{
-    int count = 0;
-    for (int j = 0; j < PAGE_NUM; j++)
-    {
-        if (page_array[j] == 0)
-        {
-            process->frames[count] = j;
-            count++;
-            page_array[j] = 1;
-            if (count == frame_needed)
-            {
-                break;
-            }
-        }
+        if (item[length] == '\0')
+            return 0;
+        item += length + 1;
     }
-    return 0;
 }
 
-void printMemoryFrames(Process *process, int num_page)
+// Function to run the jobs of the sweep until none are left
+void *runSweepJobs(void *unused)
 {
-    for (int i = 0; i < num_page; i++)
+    while (1)
     {
-        int pageIndex = process->frames[i];
-        if (pageIndex != -1)
-        { // Check if the slot is used
-            if (i < num_page - 1)
-            {
-                printf("%d,", pageIndex); // Print with a comma for all but the last index
-                continue;
-            }
-            else
-            {
-                printf("%d", pageIndex); // Last index printed without a comma
-            }
-        }
-    }
-}
+        pthread_mutex_lock(&sweep.lock);
+        int index = sweep.next_job++;
+        pthread_mutex_unlock(&sweep.lock);
+        if (index >= sweep.job_count)
+            return NULL;
 
-int getPagedMemoryUsage()
-{
-    int allocated = 0;
-    for (int i = 0; i < PAGE_NUM; i++)
-    {
-        if (page_array[i] == 1)
-        {
-            allocated++;
-        }
+        struct SweepJob *job = &sweep.jobs[index];
+        job->failed = sched_run(job->ctx) != 0 || sched_result(job->ctx, &job->result) != 0;
+        sched_destroy(job->ctx);
     }
-    int memory_usage_perc = ceil(100 * (double)allocated / PAGE_NUM);
-    return memory_usage_perc;
 }
 
-int singleTurnoverTime(int service_time, int current_time)
+// Function to create the simulation of every job, all replaying the trace
+// of the sweep. Returns 0 on success; on failure none are left.
+int createSweepJobs()
 {
-    int total_Single = current_time;
-    double turn_over = (double)total_Single / service_time;
-    for (int i = 0; i < total_process; ++i)
-    {
-        if (overhead_array[i] == 0)
-        {
-            overhead_array[i] = turn_over;
-            break;
+    struct sched_config config = options;
+    config.output_fd = -1;     // Only the summaries are kept
+    config.report_skipped = 0; // Every job would repeat the same messages
+
+    sweep.job_count = sweep.strategy_count * sweep.quantum_count;
+    sweep.jobs = resizeArray(NULL, sweep.job_count, sizeof(struct SweepJob));
+    for (int i = 0; i < sweep.job_count; i++)
+    {
+        struct SweepJob *job = &sweep.jobs[i];
+        job->quantum = sweep.quanta[i % sweep.quantum_count];
+        job->memory_strategy = sweep.strategies[i / sweep.quantum_count];
+        config.quantum = job->quantum;
+        config.memory_strategy = job->memory_strategy;
+        job->ctx = sched_create(&config);
+        if (job->ctx != NULL && sched_load_trace(job->ctx, sweep.trace) != 0)
+        {
+            sched_destroy(job->ctx);
+            job->ctx = NULL;
+        }
+        if (job->ctx == NULL)
+        {
+            // Settings that are wrong for one run are wrong for the sweep
+            while (i-- > 0)
+                sched_destroy(sweep.jobs[i].ctx);
+            return 1;
         }
     }
     return 0;
 }
 
-void calculateTurnoverTime(int end_time, int start_time)
-{
-    total_turnovertime = total_turnovertime + (end_time - start_time);
-}
-
-void calculateAverageTurnover(int total_turnovertime, int total_process)
+// Function to run every simulation of the sweep on one thread per core and
+// print their summaries as one table, in the order the settings were given.
+// A run that does not finish is marked as failed in its row and fails the
+// sweep.
+int runSweep()
 {
-    double average_turnover = ceil((double)total_turnovertime / total_process);
-
-    printf("Turnaround time %.0f\n", average_turnover);
-}
-void calculateMakeSpan(int time)
-{
-    make_span = make_span + time;
-}
+    sweep.trace = sched_trace_read(filename);
+    if (sweep.trace == NULL)
+        return 1;
+    int failed = createSweepJobs();
 
-double calculateTimeOverhead(int turnaround_time, int service_time)
-{
-    for (int i = 0; i < total_process; ++i)
+    if (!failed)
     {
-        if (overhead_array[i] == 0)
+        sweep.next_job = 0;
+        pthread_mutex_init(&sweep.lock, NULL);
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        int worker_count = cores < 1 ? 1 : cores < sweep.job_count ? (int)cores : sweep.job_count;
+        pthread_t *workers = resizeArray(NULL, worker_count, sizeof(pthread_t));
+        int started = 0;
+        while (started < worker_count && pthread_create(&workers[started], NULL, runSweepJobs, NULL) == 0)
+            started++;
+        if (started == 0)
+            runSweepJobs(NULL); // No thread could be started, so run the jobs here
+        for (int i = 0; i < started; i++)
         {
-            overhead_array[i] = (double)turnaround_time / service_time;
+            pthread_join(workers[i], NULL);
         }
-    }
-    return (double)turnaround_time / service_time;
-}
-
-void printOverhead()
-{
-    double maxOverhead = 0.0;
-    double sumOverhead = 0.0;
-    int count = 0; // To handle cases where array might have zero or non-positive values.
+        pthread_mutex_destroy(&sweep.lock);
+        free(workers);
 
-    // Iterate through each overhead value in the array
-    for (int i = 0; i < total_process; ++i)
-    {
-        if (overhead_array[i] > 0)
-        { // Assuming you want to ignore non-positive overhead values
-            // Update the maxOverhead if the current element is greater
-            if (overhead_array[i] > maxOverhead)
+        printf(options.replacement_policy != NULL ? "quantum,memory,turnaround,max-overhead,average-overhead,evictions,makespan\n"
+                                                  : "quantum,memory,turnaround,max-overhead,average-overhead,makespan\n");
+        for (int i = 0; i < sweep.job_count; i++)
+        {
+            struct SweepJob *job = &sweep.jobs[i];
+            if (job->failed)
             {
-                maxOverhead = overhead_array[i];
+                fprintf(stderr, "The run with quantum %d and memory %s did not finish\n", job->quantum, job->memory_strategy);
+                printf("%d,%s,failed\n", job->quantum, job->memory_strategy);
+                failed = 1;
+                continue;
             }
-            // Add the current element to the sumOverhead
-            sumOverhead += overhead_array[i];
-            ++count;
+            printf("%d,%s,%.0f,%.2f,%.2f,", job->quantum, job->memory_strategy, job->result.average_turnover,
+                   job->result.max_overhead, job->result.average_overhead);
+            if (options.replacement_policy != NULL)
+                printf("%d,", job->result.evictions);
+            printf("%d\n", job->result.makespan);
         }
     }
 
-    // Calculate the average overhead
-    double averageOverhead = (count > 0) ? (sumOverhead / count) : 0.0;
-
-    // Print the maximum and average overhead values
-    printf("%.2f ", maxOverhead);
-    printf("%.2f\n", averageOverhead);
-}
-
-int parse(int argc, char *argv[])
-{
-    int opt;
-    while ((opt = getopt(argc, argv, "f:m:q:")) != -1)
+    free(sweep.jobs);
+    sched_trace_free(sweep.trace);
+    free(sweep.quanta);
+    for (int i = 0; i < sweep.strategy_count; i++)
     {
-        switch (opt)
-        {
-        case 'f':
-            filename = optarg;
-            break;
-        case 'm':
-            memory_strategy = optarg;
-            break;
-        case 'q':
-            quantum_time = atoi(optarg);
-            break;
-        default:
-            perror("Error reading command line parameters");
-            return 1;
-        }
+        free(sweep.strategies[i]);
     }
-    return 0;
+    free(sweep.strategies);
+    return failed;
 }
 
-// Reads each line of the input file and enwraps the parameters
-// into a process instance. Enqueue the process.
-int readInput()
+// Function to write a snapshot of the run to <prefix><time>.snap
+int writeCheckpoint(sched_ctx *ctx)
 {
-    FILE *input = fopen(filename, "r");
-    if (input == NULL)
-    {
-        perror("Error opening file");
+    void *data;
+    size_t size;
+    if (sched_snapshot(ctx, &data, &size) != 0)
         return 1;
-    }
-
-    char line[MAX_LINE_LENGTH];
-    unready_processes = createQueue();
-
-    int id = 0;
-
-    while (fgets(line, sizeof(line), input))
-    {
-        struct Process *new_process = malloc(sizeof(struct Process));
-        if (new_process == NULL)
-        {
-            perror("Memory allocation failed");
-            fclose(input); // Close the file before returning
-            return 1;
-        }
-
-        int arrival_time;
-        char name[10];
-        int remaining_time;
-        int memory_executed_proc_arr_size;
 
-        // Scan the line to extract values
-        if (sscanf(line, "%d %9s %d %d", &arrival_time, name, &remaining_time, &memory_executed_proc_arr_size) != 4)
-        {
-            perror("Error parsing input");
-            free(new_process->name); // Free the name field
-            free(new_process);       // Free the memory for the newly allocated Process struct
-            fclose(input);           // Close the file before returning
-            return 1;
-        }
-
-        // Allocate memory for the name field and copy the string into it
-        new_process->name = strdup(name);
-        if (new_process->name == NULL)
-        {
-            perror("Memory allocation failed");
-            free(new_process); // Free the memory for the newly allocated Process struct
-            fclose(input);     // Close the file before returning
-            return 1;
-        }
-
-        // Assign the scanned values to the process
-        new_process->pid = id;
-        new_process->arrival_time = arrival_time;
-        new_process->remaining_time = remaining_time;
-        new_process->memory_executed_proc_arr_size = memory_executed_proc_arr_size;
-        new_process->status = UNREADY;          // Initialise the status to UNREADY
-        new_process->memory_start_address = -1; // Initialse the start address to be -1 as memory is not allocated for the process yet
-        new_process->total_page = 0;
-        new_process->sum_remaining_time = remaining_time;
-
-        enqueue(unready_processes, new_process);
-
-        process_count += 1; // Increase the total process count by 1
-        id++;               // Increase the id by one for the next process
-        total_process += 1;
-    }
-    fclose(input);
-    return 0;
+    char name[4096];
+    snprintf(name, sizeof(name), "%s%d.snap", checkpoints.prefix, sched_time(ctx));
+    FILE *file = fopen(name, "wb");
+    int failed = file == NULL || fwrite(data, 1, size, file) != size;
+    if (file != NULL && fclose(file) != 0)
+        failed = 1;
+    if (failed)
+        perror("Error writing snapshot");
+    free(data);
+    return failed;
 }
 
-int schedule()
+// Function to resume the run from the snapshot given with --restore
+int restoreCheckpoint(sched_ctx *ctx)
 {
-    ready_processes = createQueue();
-    Process *current_process = NULL; // Initialize current_process to NULL
-    int ready_process_count = 0;
-
-    while (process_count > 0)
+    FILE *file = fopen(checkpoints.restore, "rb");
+    if (file == NULL)
     {
-        // Check for processes ready to run
-        while (!isEmpty(unready_processes) && top(unready_processes)->arrival_time <= current_time)
-        {
-            Process *new_process = dequeue(unready_processes);
-            new_process->status = READY;
-            enqueue(ready_processes, new_process);
-            ready_process_count++;
-        }
-
-        // Update remaining time of current process
-        if (current_process != NULL)
-        {
-            current_process->remaining_time -= quantum_time;
-
-            // Execution of current process completed
-            if (current_process->remaining_time <= 0)
-            {
-                process_count--; // Decrease the count of unfinished processes
-                singleTurnoverTime(current_process->sum_remaining_time, current_time - current_process->arrival_time);
-                tryFreeMemory(current_process); // Free the memory
-
-                // Print finished process
-                printf("%d,%s,process-name=%s,proc-remaining=%d\n",
-                       current_time, "FINISHED", current_process->name, ready_process_count);
-                calculateTurnoverTime(current_time, current_process->arrival_time);
-
-                current_process->status = FINISHED;
-                removeFnishedProcFromArr();
-                free(current_process->name); // Free memory allocated for current_process
-                free(current_process);       // Free memory allocated for current_process
-                current_process = NULL;      // Set current_process to NULL
-            }
-        }
-
-        // Check if there are any ready processes
-        if (isEmpty(ready_processes))
-        {
-            // No process is ready
-            if (current_process == NULL)
-            {
-                // If there is no current running process,
-                // add quantum time to current time and wait
-                current_time += quantum_time;
-                continue;
-            }
-            // If there is a current running process,
-            // keep it running instead of changing its status to ready
-        }
-        else
-        {
-            // If there are RUNNING processes,
-            // change the status of the running process to READY
-            // and put it at the end of the queue
-            if (current_process != NULL)
-            {
-                current_process->status = READY;
-                enqueue(ready_processes, current_process);
-                ready_process_count++;
-            }
-
-            Process *next_process = NULL;
-
-            // Try allocate memory to the next process until successful
-            while (1)
-            {
-                next_process = dequeue(ready_processes);
-
-                int allocated = tryAllocateMemory(next_process, ready_processes);
-
-                // If the allocation is not successful, put it at the end of the queue
-                if (!allocated)
-                {
-                    enqueue(ready_processes, next_process);
-                }
-                else
-                {
-                    break;
-                }
-            }
-
-            // Run the first process in the ready queue
-            // and change its status to RUNNING
-            current_process = next_process;
-            ready_process_count--;
-            current_process->status = RUNNING;
-            addToExecutedProcArr(current_process);
-            if (current_process->remaining_time > 0)
-            {
-                // Print running process
-                printf("%d,%s,process-name=%s,remaining-time=%d",
-                       current_time, "RUNNING", current_process->name, current_process->remaining_time);
-                if (strcmp(memory_strategy, "first-fit") == 0)
-                {
-                    int memory_usage_perc = ceil(100 * (double)memory_usage / MEMORY_SIZE);
-
-                    printf(",mem-usage=%d%%,allocated-at=%d", memory_usage_perc, current_process->memory_start_address);
-                }
-                if (strcmp(memory_strategy, "paged") == 0)
-                {
-                    int memory_usage_perc = getPagedMemoryUsage();
-
-                    printf(",mem-usage=%d%%,", memory_usage_perc);
-                    printf("mem-frames=[");
-                    printMemoryFrames(current_process, current_process->total_page);
-                    printf("]");
-                }
-                if (strcmp(memory_strategy, "virtual") == 0)
-                {
-                    int memory_usage_perc = getPagedMemoryUsage();
-
-                    printf(",mem-usage=%d%%,", memory_usage_perc);
-                    printf("mem-frames=[");
-                    printMemoryFrames(current_process, current_process->total_page);
-                    printf("]");
-                }
-
-                printf("\n");
-            }
-        }
-
-        current_time += quantum_time; // Update current time
+        perror("Error opening snapshot");
+        return 1;
     }
-
-    calculateAverageTurnover(total_turnovertime, total_process);
-    printf("Time overhead ");
-    printOverhead();
-    printf("Makespan %d", (current_time - quantum_time));
-    fflush(stdout);
-    return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    void *data = resizeArray(NULL, size > 0 ? size : 1, 1);
+    int failed = size < 0 || fread(data, 1, size, file) != (size_t)size;
+    fclose(file);
+    if (failed)
+        perror("Error reading snapshot");
+    else
+        failed = sched_restore(ctx, data, size);
+    free(data);
+    return failed;
 }
 
-void cleanUp()
+// Function to run the simulation to the end, writing a snapshot at the
+// first step boundary at or after every multiple of --checkpoint-every
+int runSimulation(sched_ctx *ctx)
 {
-    while (!isEmpty(unready_processes))
-    {
-        struct Process *process = dequeue(unready_processes);
-        free(process->name);
-        free(process);
-    }
+    if (checkpoints.every == 0)
+        return sched_run(ctx);
 
-    free(unready_processes);
-
-    while (!isEmpty(ready_processes))
+    int next_checkpoint = (sched_time(ctx) / checkpoints.every + 1) * checkpoints.every;
+    int status;
+    while ((status = sched_step(ctx)) == 1)
     {
-        struct Process *process = dequeue(ready_processes);
-        free(process->name);
-        free(process);
+        if (sched_time(ctx) < next_checkpoint)
+            continue;
+        if (writeCheckpoint(ctx) != 0)
+            return 1;
+        next_checkpoint = (sched_time(ctx) / checkpoints.every + 1) * checkpoints.every;
     }
-    free(ready_processes);
-
-    free(executed_proc_arr);
+    return status != 0;
 }
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Metrics file layout. CSV is a header line and one line per sample. The
+// binary form is "RRMT", then little-endian u32 version, column count and
+// sampling interval, the column names each ended by a NUL, and then blocks
+// of up to METRICS_BLOCK_ROWS samples: a u32 row count followed by every
+// column in turn as that many little-endian i32 values.
+#define METRICS_MAGIC "RRMT"
+#define METRICS_VERSION 1
+#define METRICS_BLOCK_ROWS 4096
+
+enum MetricsColumn
+{
+    METRICS_TIME,
+    METRICS_READY,            // Processes waiting in the ready queue
+    METRICS_MEMORY_USAGE,     // Percentage of the memory in use
+    METRICS_FRAMES_USED,      // Frames allocated to processes
+    METRICS_EVICTIONS,        // Frames evicted since the previous sample
+    METRICS_CONTEXT_SWITCHES, // Context switches since the previous sample
+    METRICS_COLUMNS
+};
+
+const char *metrics_column_names[METRICS_COLUMNS] = {
+    "time", "ready", "mem-usage", "frames-used", "evictions", "context-switches"};
+
+// Define a structure to represent a time series of samples being written.
+// Samples go through a background sink; in binary form they are held back
+// until a block of them can be written column by column.
+struct Metrics
+{
+    struct OutputSink *sink;
+    int binary;
+    int every;                 // Simulated time between samples
+    int sampled_evictions;     // Counters at the previous sample
+    int sampled_switches;
+    int32_t (*block)[METRICS_BLOCK_ROWS]; // Columns of the held-back samples
+    int block_rows;
+};
+
+// Function to start writing samples to the file descriptor
+struct Metrics *createMetrics(int fd, int binary, int every)
+{
+    struct Metrics *metrics = (struct Metrics *)malloc(sizeof(struct Metrics));
+    if (metrics == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    metrics->sink = createBackgroundSink(fd);
+    metrics->binary = binary;
+    metrics->every = every;
+    metrics->sampled_evictions = 0;
+    metrics->sampled_switches = 0;
+    metrics->block = NULL;
+    metrics->block_rows = 0;
+
+    if (!binary)
+    {
+        for (int column = 0; column < METRICS_COLUMNS; column++)
+        {
+            if (column > 0)
+                outputChar(metrics->sink, ',');
+            outputString(metrics->sink, metrics_column_names[column]);
+        }
+        outputChar(metrics->sink, '\n');
+        return metrics;
+    }
+
+    metrics->block = malloc(METRICS_COLUMNS * sizeof(*metrics->block));
+    if (metrics->block == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    char header[16];
+    memcpy(header, METRICS_MAGIC, 4);
+    writeLittleEndian32(header + 4, METRICS_VERSION);
+    writeLittleEndian32(header + 8, METRICS_COLUMNS);
+    writeLittleEndian32(header + 12, (uint32_t)every);
+    outputBytes(metrics->sink, header, sizeof(header));
+    for (int column = 0; column < METRICS_COLUMNS; column++)
+    {
+        outputBytes(metrics->sink, metrics_column_names[column], strlen(metrics_column_names[column]) + 1);
+    }
+    return metrics;
+}
+
+// Write the held-back samples as one block
+void writeMetricsBlock(struct Metrics *metrics)
+{
+    if (metrics->block_rows == 0)
+        return;
+    char bytes[4];
+    writeLittleEndian32(bytes, (uint32_t)metrics->block_rows);
+    outputBytes(metrics->sink, bytes, sizeof(bytes));
+    for (int column = 0; column < METRICS_COLUMNS; column++)
+    {
+        for (int row = 0; row < metrics->block_rows; row++)
+        {
+            outputReserve(metrics->sink, 4);
+            writeLittleEndian32(metrics->sink->buffer + metrics->sink->length, (uint32_t)metrics->block[column][row]);
+            metrics->sink->length += 4;
+        }
+    }
+    metrics->block_rows = 0;
+}
+
+// Function to add one sample, with a value for every column
+void addMetricsRow(struct Metrics *metrics, const int values[METRICS_COLUMNS])
+{
+    if (metrics->binary)
+    {
+        for (int column = 0; column < METRICS_COLUMNS; column++)
+        {
+            metrics->block[column][metrics->block_rows] = values[column];
+        }
+        if (++metrics->block_rows == METRICS_BLOCK_ROWS)
+            writeMetricsBlock(metrics);
+        return;
+    }
+    for (int column = 0; column < METRICS_COLUMNS; column++)
+    {
+        if (column > 0)
+            outputChar(metrics->sink, ',');
+        outputInt(metrics->sink, values[column]);
+    }
+    outputChar(metrics->sink, '\n');
+}
+
+// Function to write out the remaining samples and free the series
+void freeMetrics(struct Metrics *metrics)
+{
+    if (metrics->binary)
+        writeMetricsBlock(metrics);
+    freeOutputSink(metrics->sink);
+    free(metrics->block);
+    free(metrics);
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Define a list of the ways a process's frames are spread over the NUMA
+// nodes. local-first fills the node of the process and then the nodes
+// after it; interleave puts consecutive pages on consecutive nodes; bind
+// uses the node of the process only.
+enum NumaPolicy
+{
+    NUMA_LOCAL_FIRST,
+    NUMA_INTERLEAVE,
+    NUMA_BIND,
+    NUMA_POLICIES
+};
+
+const char *numa_policy_names[NUMA_POLICIES] = {"local-first", "interleave", "bind"};
+
+// Function to look up a NUMA policy by name. Returns -1 if there is none.
+int findNumaPolicy(const char *name)
+{
+    for (int i = 0; i < NUMA_POLICIES; i++)
+    {
+        if (strcmp(numa_policy_names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Define a structure to represent one NUMA node: a range of consecutive
+// frames with a frame table of its own, numbered from the node's first frame
+struct NumaNode
+{
+    int first_frame;
+    struct FrameTable *frames;
+};
+
+// Define a structure to represent the frames of the memory split into
+// nodes of (nearly) equal size. Frame numbers are global; the counts are
+// over every node.
+struct FramePools
+{
+    struct NumaNode *nodes;
+    int node_count;
+    int frame_count;
+    int free_count;
+};
+
+// Function to split frame_count frames into node_count pools, every frame free
+struct FramePools *createFramePools(int frame_count, int node_count)
+{
+    struct FramePools *pools = (struct FramePools *)malloc(sizeof(struct FramePools));
+    if (pools == NULL || (pools->nodes = (struct NumaNode *)malloc(node_count * sizeof(struct NumaNode))) == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    pools->node_count = node_count;
+    pools->frame_count = frame_count;
+    pools->free_count = frame_count;
+    for (int i = 0; i < node_count; i++)
+    {
+        int first = (int)((long long)frame_count * i / node_count);
+        int end = (int)((long long)frame_count * (i + 1) / node_count);
+        pools->nodes[i].first_frame = first;
+        pools->nodes[i].frames = createFrameTable(end - first);
+    }
+    return pools;
+}
+
+// Returns the node holding the frame
+int framePoolNode(struct FramePools *pools, int frame)
+{
+    int node = pools->node_count - 1;
+    while (node > 0 && frame < pools->nodes[node].first_frame)
+        node--;
+    return node;
+}
+
+// Function to check whether a frame is allocated
+int framePoolIsUsed(struct FramePools *pools, int frame)
+{
+    struct NumaNode *node = &pools->nodes[framePoolNode(pools, frame)];
+    return frameIsUsed(node->frames, frame - node->first_frame);
+}
+
+// Returns the number of free frames on the node, or on every node if node is -1
+int framePoolFree(struct FramePools *pools, int node)
+{
+    return node == -1 ? pools->free_count : pools->nodes[node].frames->free_count;
+}
+
+// Returns the number of frames the node holds
+int framePoolSize(struct FramePools *pools, int node)
+{
+    return pools->nodes[node].frames->frame_count;
+}
+
+// Function to take a run of at most max_frames consecutive free frames from
+// the node, starting at its lowest-numbered free frame. Returns the number
+// taken and stores the first in *start.
+int framePoolTake(struct FramePools *pools, int node, int max_frames, int *start)
+{
+    int taken = frameTakeRun(pools->nodes[node].frames, max_frames, start);
+    *start += pools->nodes[node].first_frame;
+    pools->free_count -= taken;
+    return taken;
+}
+
+// Function to take frames for the given page slot of a process whose node
+// is home, as the policy places them. Returns the number of frames taken,
+// 0 if the policy allows none, and stores the first in *start.
+int framePoolTakeFor(struct FramePools *pools, int policy, int home, int slot, int max_frames, int *start)
+{
+    if (policy == NUMA_BIND)
+        return framePoolTake(pools, home, max_frames, start);
+
+    // Interleaved pages go one at a time, each on the next node round
+    int first = home;
+    if (policy == NUMA_INTERLEAVE)
+    {
+        first = (home + slot) % pools->node_count;
+        max_frames = 1;
+    }
+    for (int i = 0; i < pools->node_count; i++)
+    {
+        int node = (first + i) % pools->node_count;
+        if (pools->nodes[node].frames->free_count > 0)
+            return framePoolTake(pools, node, max_frames, start);
+    }
+    return 0;
+}
+
+// Function to mark an allocated frame as free again
+void framePoolRelease(struct FramePools *pools, int frame)
+{
+    struct NumaNode *node = &pools->nodes[framePoolNode(pools, frame)];
+    if (!frameIsUsed(node->frames, frame - node->first_frame))
+        return;
+    frameRelease(node->frames, frame - node->first_frame);
+    pools->free_count++;
+}
+
+void freeFramePools(struct FramePools *pools)
+{
+    for (int i = 0; i < pools->node_count; i++)
+    {
+        freeFrameTable(pools->nodes[i].frames);
+    }
+    free(pools->nodes);
+    free(pools);
+}
+
+// Function to write the allocated frames of every node
+void saveFramePools(struct Snapshot *snapshot, struct FramePools *pools)
+{
+    for (int i = 0; i < pools->node_count; i++)
+    {
+        saveFrameTable(snapshot, pools->nodes[i].frames);
+    }
+}
+
+// Function to overwrite pools split the same way with the frames written
+// by saveFramePools()
+void restoreFramePools(struct Snapshot *snapshot, struct FramePools *pools)
+{
+    pools->free_count = 0;
+    for (int i = 0; i < pools->node_count; i++)
+    {
+        restoreFrameTable(snapshot, pools->nodes[i].frames);
+        pools->free_count += pools->nodes[i].frames->free_count;
+    }
+}
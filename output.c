@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_NUMBER_SIZE 16  // Room for any formatted int
+#define OUTPUT_FIXED_SIZE 400  // Room for any double printed with %.2f
+
+// Define a structure to represent the thread that writes the buffers of
+// a background sink. A full buffer is handed over as pending and comes
+// back as spare once it has been written, so the simulation only waits
+// when it fills a second buffer before the first is out.
+struct BackgroundWriter
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // Signalled when pending or closing changes
+    int fd;
+    char *pending; // Buffer being written, NULL when the thread is idle
+    size_t pending_length;
+    char *spare; // Written buffer waiting to be filled again
+    int closing; // 1 once no more buffers will come
+};
+
+// Define a structure to represent a buffered event writer. Events are
+// formatted straight into one large buffer, which is handed to write()
+// only when it fills up or the simulation ends, either here or on a
+// background thread.
+struct OutputSink
+{
+    int fd;
+    char *buffer;
+    size_t length;   // Bytes waiting to be written
+    size_t capacity;
+    struct BackgroundWriter *background; // NULL to write on the caller's thread
+};
+
+char *allocateOutputBuffer()
+{
+    char *buffer = (char *)malloc(OUTPUT_BUFFER_SIZE);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return buffer;
+}
+
+// Function to create a writer for the file descriptor
+struct OutputSink *createOutputSink(int fd)
+{
+    struct OutputSink *sink = (struct OutputSink *)malloc(sizeof(struct OutputSink));
+    if (sink == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    sink->buffer = allocateOutputBuffer();
+    sink->fd = fd;
+    sink->length = 0;
+    sink->capacity = OUTPUT_BUFFER_SIZE;
+    sink->background = NULL;
+    return sink;
+}
+
+// Hand bytes to the kernel, retrying short and interrupted writes.
+// A descriptor of -1 drops them.
+void writeOutput(int fd, const char *data, size_t size)
+{
+    if (fd < 0)
+        return;
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t count = write(fd, data + written, size - written);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Error writing output");
+            return;
+        }
+        written += count;
+    }
+}
+
+// Write the buffers handed over by the sink until it is closed
+void *runBackgroundWriter(void *argument)
+{
+    struct BackgroundWriter *writer = (struct BackgroundWriter *)argument;
+    pthread_mutex_lock(&writer->lock);
+    while (1)
+    {
+        while (writer->pending == NULL && !writer->closing)
+            pthread_cond_wait(&writer->changed, &writer->lock);
+        if (writer->pending == NULL)
+            break;
+        char *data = writer->pending;
+        size_t length = writer->pending_length;
+        pthread_mutex_unlock(&writer->lock);
+        writeOutput(writer->fd, data, length);
+        pthread_mutex_lock(&writer->lock);
+        writer->spare = data;
+        writer->pending = NULL;
+        pthread_cond_broadcast(&writer->changed);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+// Function to create a writer whose buffers are written by a thread of
+// its own, so a slow file does not hold up the simulation. It writes on
+// the caller's thread if no thread can be started.
+struct OutputSink *createBackgroundSink(int fd)
+{
+    struct OutputSink *sink = createOutputSink(fd);
+    struct BackgroundWriter *writer = (struct BackgroundWriter *)malloc(sizeof(struct BackgroundWriter));
+    if (writer == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    writer->fd = fd;
+    writer->pending = NULL;
+    writer->pending_length = 0;
+    writer->spare = allocateOutputBuffer();
+    writer->closing = 0;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->changed, NULL);
+    if (pthread_create(&writer->thread, NULL, runBackgroundWriter, writer) != 0)
+    {
+        pthread_cond_destroy(&writer->changed);
+        pthread_mutex_destroy(&writer->lock);
+        free(writer->spare);
+        free(writer);
+        return sink;
+    }
+    sink->background = writer;
+    return sink;
+}
+
+// Function to write out everything that is buffered. A background sink
+// swaps in the spare buffer once the thread has finished with it.
+void outputFlush(struct OutputSink *sink)
+{
+    struct BackgroundWriter *writer = sink->background;
+    if (writer == NULL)
+    {
+        writeOutput(sink->fd, sink->buffer, sink->length);
+        sink->length = 0;
+        return;
+    }
+    if (sink->length == 0)
+        return;
+    pthread_mutex_lock(&writer->lock);
+    while (writer->pending != NULL)
+        pthread_cond_wait(&writer->changed, &writer->lock);
+    writer->pending = sink->buffer;
+    writer->pending_length = sink->length;
+    sink->buffer = writer->spare;
+    writer->spare = NULL;
+    pthread_cond_broadcast(&writer->changed);
+    pthread_mutex_unlock(&writer->lock);
+    sink->length = 0;
+}
+
+// Make sure the buffer has room for the given number of bytes
+void outputReserve(struct OutputSink *sink, size_t size)
+{
+    if (sink->length + size > sink->capacity)
+        outputFlush(sink);
+}
+
+void outputChar(struct OutputSink *sink, char c)
+{
+    outputReserve(sink, 1);
+    sink->buffer[sink->length++] = c;
+}
+
+// Function to append bytes, a buffer at a time if there are many
+void outputBytes(struct OutputSink *sink, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        outputReserve(sink, size < sink->capacity ? size : sink->capacity);
+        size_t count = sink->capacity - sink->length < size ? sink->capacity - sink->length : size;
+        memcpy(sink->buffer + sink->length, data, count);
+        sink->length += count;
+        data += count;
+        size -= count;
+    }
+}
+
+void outputString(struct OutputSink *sink, const char *text)
+{
+    outputBytes(sink, text, strlen(text));
+}
+
+// Function to append an integer in decimal
+void outputInt(struct OutputSink *sink, int value)
+{
+    char digits[OUTPUT_NUMBER_SIZE];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    outputReserve(sink, count + 1);
+    if (value < 0)
+        sink->buffer[sink->length++] = '-';
+    while (count > 0)
+    {
+        sink->buffer[sink->length++] = digits[--count];
+    }
+}
+
+// Function to append a number rounded to a fixed count of decimals,
+// formatted exactly as printf's %.Nf
+void outputFixed(struct OutputSink *sink, double value, int decimals)
+{
+    char text[OUTPUT_FIXED_SIZE];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    outputString(sink, text);
+}
+
+// Function to flush and free the writer, waiting for a background
+// thread to write everything out
+void freeOutputSink(struct OutputSink *sink)
+{
+    outputFlush(sink);
+    struct BackgroundWriter *writer = sink->background;
+    if (writer != NULL)
+    {
+        pthread_mutex_lock(&writer->lock);
+        writer->closing = 1;
+        pthread_cond_broadcast(&writer->changed);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+        pthread_cond_destroy(&writer->changed);
+        pthread_mutex_destroy(&writer->lock);
+        free(writer->spare);
+        free(writer);
+    }
+    free(sink->buffer);
+    free(sink);
+}
+
+// Define a structure to represent a frame list being written, either as
+// every frame number ("0,1,2,7") or as ranges of consecutive frames
+// ("0-2,7"). In range mode the last range is held back until it can no
+// longer grow.
+struct FramePrinter
+{
+    struct OutputSink *sink;
+    int as_ranges;
+    int written; // Number of items written so far
+    int start;   // First frame of the held-back range
+    int length;  // Length of the held-back range, 0 if there is none
+};
+
+void startFrames(struct FramePrinter *printer, struct OutputSink *sink, int as_ranges)
+{
+    printer->sink = sink;
+    printer->as_ranges = as_ranges;
+    printer->written = 0;
+    printer->length = 0;
+}
+
+// Write the held-back range
+void outputHeldRange(struct FramePrinter *printer)
+{
+    if (printer->length == 0)
+        return;
+    if (printer->written++ > 0)
+        outputChar(printer->sink, ',');
+    outputInt(printer->sink, printer->start);
+    if (printer->length > 1)
+    {
+        outputChar(printer->sink, '-');
+        outputInt(printer->sink, printer->start + printer->length - 1);
+    }
+    printer->length = 0;
+}
+
+// Function to write a run of consecutive frames
+void outputFrameRun(struct FramePrinter *printer, int start, int length)
+{
+    if (!printer->as_ranges)
+    {
+        for (int frame = start; frame < start + length; frame++)
+        {
+            if (printer->written++ > 0)
+                outputChar(printer->sink, ',');
+            outputInt(printer->sink, frame);
+        }
+        return;
+    }
+    if (printer->length > 0 && printer->start + printer->length == start)
+    {
+        printer->length += length;
+        return;
+    }
+    outputHeldRange(printer);
+    printer->start = start;
+    printer->length = length;
+}
+
+// Function to write whatever is still held back
+void finishFrames(struct FramePrinter *printer)
+{
+    if (printer->as_ranges)
+        outputHeldRange(printer);
+}
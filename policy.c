@@ -0,0 +1,636 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#define MLFQ_LEVELS 3          // Number of priority levels in the multi-level feedback queue
+#define MLFQ_BOOST_PERIOD 64   // Dispatches between lifting every process back to the top level
+#define DEFAULT_TICKETS 100    // Tickets held by each process under lottery and stride
+#define STRIDE_ONE (1 << 20)   // Numerator of the stride, 1 / tickets in fixed point
+
+// Define a structure to represent a scheduling policy. The scheduler calls
+// admit when a process arrives, preempt when the running process gives the
+// CPU back at the end of a quantum, requeue when a dispatched process could
+// not get memory and has to wait without having run, dispatch to take the
+// process that runs next and finish when a process completes. save writes
+// the ready processes and the rest of the state into a snapshot, and
+// restore reads them back into a state just made by create.
+struct SchedulerPolicy
+{
+    const char *name;
+    void *(*create)(uint64_t seed);
+    void (*admit)(void *state, struct Process *process);
+    void (*preempt)(void *state, struct Process *process);
+    void (*requeue)(void *state, struct Process *process);
+    struct Process *(*dispatch)(void *state);
+    void (*finish)(void *state, struct Process *process);
+    void (*destroy)(void *state);
+    void (*save)(void *state, struct Snapshot *snapshot);
+    void (*restore)(void *state, struct Snapshot *snapshot);
+};
+
+// Define a structure to represent the ready processes under a policy
+struct ReadyQueue
+{
+    const struct SchedulerPolicy *policy;
+    void *state;
+    int size; // Number of ready processes
+};
+
+void *allocatePolicyState(size_t size)
+{
+    void *state = calloc(1, size);
+    if (state == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return state;
+}
+
+void finishNothing(void *state, struct Process *process)
+{
+}
+
+// ---- Round robin: one FIFO queue ----
+
+void *createRoundRobin(uint64_t seed)
+{
+    return createQueue();
+}
+
+void enqueueRoundRobin(void *state, struct Process *process)
+{
+    enqueue((struct Queue *)state, process);
+}
+
+struct Process *dispatchRoundRobin(void *state)
+{
+    return dequeue((struct Queue *)state);
+}
+
+void destroyRoundRobin(void *state)
+{
+    freeQueue((struct Queue *)state);
+}
+
+void saveRoundRobin(void *state, struct Snapshot *snapshot)
+{
+    saveQueue(snapshot, (struct Queue *)state);
+}
+
+void restoreRoundRobin(void *state, struct Snapshot *snapshot)
+{
+    restoreQueue(snapshot, (struct Queue *)state);
+}
+
+// ---- Binary min-heap of processes, shared by SRTF and stride ----
+
+struct HeapEntry
+{
+    long long key;
+    long long sequence; // Insertion order, so equal keys leave in FIFO order
+    struct Process *process;
+};
+
+struct ProcessHeap
+{
+    struct HeapEntry *entries;
+    int size;
+    int capacity;
+    long long next_sequence;
+    long long pass; // Stride only: pass of the last dispatched process
+};
+
+int heapEntryBefore(struct HeapEntry *a, struct HeapEntry *b)
+{
+    return a->key < b->key || (a->key == b->key && a->sequence < b->sequence);
+}
+
+void heapPush(struct ProcessHeap *heap, long long key, struct Process *process)
+{
+    if (heap->size == heap->capacity)
+    {
+        heap->capacity = heap->capacity ? heap->capacity * 2 : 16;
+        heap->entries = (struct HeapEntry *)realloc(heap->entries, heap->capacity * sizeof(struct HeapEntry));
+        if (heap->entries == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    struct HeapEntry entry = {key, heap->next_sequence++, process};
+    int i = heap->size++;
+    while (i > 0 && heapEntryBefore(&entry, &heap->entries[(i - 1) / 2]))
+    {
+        heap->entries[i] = heap->entries[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->entries[i] = entry;
+}
+
+struct HeapEntry heapPop(struct ProcessHeap *heap)
+{
+    struct HeapEntry top = heap->entries[0];
+    struct HeapEntry last = heap->entries[--heap->size];
+    int i = 0;
+    while (2 * i + 1 < heap->size)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < heap->size && heapEntryBefore(&heap->entries[child + 1], &heap->entries[child]))
+            child++;
+        if (!heapEntryBefore(&heap->entries[child], &last))
+            break;
+        heap->entries[i] = heap->entries[child];
+        i = child;
+    }
+    heap->entries[i] = last;
+    return top;
+}
+
+void *createProcessHeap(uint64_t seed)
+{
+    return allocatePolicyState(sizeof(struct ProcessHeap));
+}
+
+void destroyProcessHeap(void *state)
+{
+    free(((struct ProcessHeap *)state)->entries);
+    free(state);
+}
+
+// The entries are written in heap order, so restoring them keeps the heap
+void saveProcessHeap(void *state, struct Snapshot *snapshot)
+{
+    struct ProcessHeap *heap = (struct ProcessHeap *)state;
+    writeSnapshotInt(snapshot, heap->size);
+    for (int i = 0; i < heap->size; i++)
+    {
+        writeSnapshotLong(snapshot, heap->entries[i].key);
+        writeSnapshotLong(snapshot, heap->entries[i].sequence);
+        writeProcessRef(snapshot, heap->entries[i].process);
+    }
+    writeSnapshotLong(snapshot, heap->next_sequence);
+    writeSnapshotLong(snapshot, heap->pass);
+}
+
+void restoreProcessHeap(void *state, struct Snapshot *snapshot)
+{
+    struct ProcessHeap *heap = (struct ProcessHeap *)state;
+    int size = readSnapshotRange(snapshot, 0, snapshot->process_count);
+    if (size > 0)
+    {
+        heap->entries = (struct HeapEntry *)malloc(size * sizeof(struct HeapEntry));
+        if (heap->entries == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        heap->capacity = size;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        heap->entries[i].key = readSnapshotLong(snapshot);
+        heap->entries[i].sequence = readSnapshotLong(snapshot);
+        heap->entries[i].process = readProcessRef(snapshot);
+        if (heap->entries[i].process == NULL)
+            snapshot->failed = 1;
+    }
+    heap->size = snapshot->failed ? 0 : size;
+    heap->next_sequence = readSnapshotLong(snapshot);
+    heap->pass = readSnapshotLong(snapshot);
+}
+
+// ---- Shortest remaining time first ----
+
+void enqueueShortestRemaining(void *state, struct Process *process)
+{
+    heapPush((struct ProcessHeap *)state, process->remaining_time, process);
+}
+
+struct Process *dispatchShortestRemaining(void *state)
+{
+    struct ProcessHeap *heap = (struct ProcessHeap *)state;
+    return heap->size == 0 ? NULL : heapPop(heap).process;
+}
+
+// ---- Stride: the process with the lowest pass runs, then its pass
+// advances by its stride ----
+
+void admitStride(void *state, struct Process *process)
+{
+    // A newcomer starts level with the process that ran last so it
+    // neither starves nor monopolises the CPU
+    struct ProcessHeap *heap = (struct ProcessHeap *)state;
+    process->pass = heap->pass;
+    heapPush(heap, process->pass, process);
+}
+
+void preemptStride(void *state, struct Process *process)
+{
+    process->pass += STRIDE_ONE / process->tickets;
+    heapPush((struct ProcessHeap *)state, process->pass, process);
+}
+
+void requeueStride(void *state, struct Process *process)
+{
+    heapPush((struct ProcessHeap *)state, process->pass, process);
+}
+
+struct Process *dispatchStride(void *state)
+{
+    struct ProcessHeap *heap = (struct ProcessHeap *)state;
+    if (heap->size == 0)
+        return NULL;
+    struct HeapEntry entry = heapPop(heap);
+    heap->pass = entry.key;
+    return entry.process;
+}
+
+// ---- Multi-level feedback queue: a ring buffer per level. A process that
+// uses a whole quantum drops a level; every level is lifted back to the top
+// periodically so long jobs are not starved. A boost only starts a new
+// epoch: a process queued in an earlier epoch counts as top level, behind
+// the processes queued there before the same boost, and takes level 0
+// when it is dispatched ----
+
+struct FeedbackQueues
+{
+    struct Queue *levels[MLFQ_LEVELS];
+    int dispatches; // Dispatches since the last boost
+    int epoch;      // Boosts so far
+};
+
+void *createFeedbackQueues(uint64_t seed)
+{
+    struct FeedbackQueues *queues = allocatePolicyState(sizeof(struct FeedbackQueues));
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+    {
+        queues->levels[i] = createQueue();
+    }
+    return queues;
+}
+
+void enqueueFeedback(struct FeedbackQueues *queues, struct Process *process)
+{
+    process->boost_epoch = queues->epoch;
+    enqueue(queues->levels[process->level], process);
+}
+
+void admitFeedback(void *state, struct Process *process)
+{
+    process->level = 0;
+    enqueueFeedback((struct FeedbackQueues *)state, process);
+}
+
+void preemptFeedback(void *state, struct Process *process)
+{
+    if (process->level < MLFQ_LEVELS - 1)
+        process->level++;
+    enqueueFeedback((struct FeedbackQueues *)state, process);
+}
+
+void requeueFeedback(void *state, struct Process *process)
+{
+    enqueueFeedback((struct FeedbackQueues *)state, process);
+}
+
+struct Process *dispatchFeedback(void *state)
+{
+    struct FeedbackQueues *queues = (struct FeedbackQueues *)state;
+    if (++queues->dispatches == MLFQ_BOOST_PERIOD)
+    {
+        queues->dispatches = 0;
+        queues->epoch++;
+    }
+
+    // Each level is in queuing order, so the first process of one of the
+    // levels runs next: the top level ones, boosted or not, by the epoch
+    // they were queued in and then by level, ahead of the rest by level
+    int best = -1;
+    long long best_rank = 0;
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+    {
+        struct Process *process = top(queues->levels[i]);
+        if (process == NULL)
+            continue;
+        long long rank = i == 0 || process->boost_epoch != queues->epoch
+                             ? (long long)process->boost_epoch * MLFQ_LEVELS + i
+                             : (long long)(queues->epoch + 1) * MLFQ_LEVELS + i;
+        if (best == -1 || rank < best_rank)
+        {
+            best = i;
+            best_rank = rank;
+        }
+    }
+    if (best == -1)
+        return NULL;
+    struct Process *process = dequeue(queues->levels[best]);
+    if (process->boost_epoch != queues->epoch)
+        process->level = 0;
+    return process;
+}
+
+void destroyFeedbackQueues(void *state)
+{
+    struct FeedbackQueues *queues = (struct FeedbackQueues *)state;
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+    {
+        freeQueue(queues->levels[i]);
+    }
+    free(queues);
+}
+
+// Each level is followed by the epochs its processes were queued in
+void saveFeedbackQueues(void *state, struct Snapshot *snapshot)
+{
+    struct FeedbackQueues *queues = (struct FeedbackQueues *)state;
+    writeSnapshotInt(snapshot, queues->dispatches);
+    writeSnapshotInt(snapshot, queues->epoch);
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+    {
+        struct Queue *level = queues->levels[i];
+        saveQueue(snapshot, level);
+        for (int j = 0; j < level->size; j++)
+        {
+            writeSnapshotInt(snapshot, level->items[(level->front + j) % level->capacity]->boost_epoch);
+        }
+    }
+}
+
+void restoreFeedbackQueues(void *state, struct Snapshot *snapshot)
+{
+    struct FeedbackQueues *queues = (struct FeedbackQueues *)state;
+    queues->dispatches = readSnapshotRange(snapshot, 0, MLFQ_BOOST_PERIOD - 1);
+    queues->epoch = readSnapshotRange(snapshot, 0, INT_MAX);
+    for (int i = 0; i < MLFQ_LEVELS && !snapshot->failed; i++)
+    {
+        struct Queue *level = queues->levels[i];
+        restoreQueue(snapshot, level);
+        for (int j = 0; j < level->size; j++)
+        {
+            level->items[(level->front + j) % level->capacity]->boost_epoch = readSnapshotRange(snapshot, 0, queues->epoch);
+        }
+    }
+}
+
+// ---- Lottery: every ready process sits in a slot of a Fenwick tree over
+// ticket counts, so drawing the winning ticket is a O(log n) descent ----
+
+struct Lottery
+{
+    struct Process **slots;
+    long long *tree;    // Fenwick tree of tickets, 1-based
+    int capacity;       // Number of slots, a power of two
+    int *free_slots;    // Stack of empty slots
+    int free_count;
+    long long total_tickets;
+    uint64_t random;    // xorshift64 state
+};
+
+void fenwickAdd(struct Lottery *lottery, int slot, long long tickets)
+{
+    for (int i = slot + 1; i <= lottery->capacity; i += i & -i)
+    {
+        lottery->tree[i] += tickets;
+    }
+}
+
+// Resize the slot array and rebuild the tree around the ready processes
+void growLottery(struct Lottery *lottery)
+{
+    int old_capacity = lottery->capacity;
+    int capacity = old_capacity ? old_capacity * 2 : 16;
+    struct Process **slots = (struct Process **)calloc(capacity, sizeof(struct Process *));
+    long long *tree = (long long *)calloc(capacity + 1, sizeof(long long));
+    int *free_slots = (int *)malloc(capacity * sizeof(int));
+    if (slots == NULL || tree == NULL || free_slots == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    if (old_capacity > 0)
+        memcpy(slots, lottery->slots, old_capacity * sizeof(struct Process *));
+    free(lottery->slots);
+    free(lottery->tree);
+    free(lottery->free_slots);
+    lottery->slots = slots;
+    lottery->tree = tree;
+    lottery->free_slots = free_slots;
+    lottery->capacity = capacity;
+
+    lottery->free_count = 0;
+    for (int i = capacity - 1; i >= 0; i--)
+    {
+        if (slots[i] == NULL)
+            free_slots[lottery->free_count++] = i;
+        else
+            fenwickAdd(lottery, i, slots[i]->tickets);
+    }
+}
+
+void *createLottery(uint64_t seed)
+{
+    struct Lottery *lottery = allocatePolicyState(sizeof(struct Lottery));
+    lottery->random = seed ? seed : 1;
+    growLottery(lottery);
+    return lottery;
+}
+
+void enqueueLottery(void *state, struct Process *process)
+{
+    struct Lottery *lottery = (struct Lottery *)state;
+    if (lottery->free_count == 0)
+        growLottery(lottery);
+    int slot = lottery->free_slots[--lottery->free_count];
+    lottery->slots[slot] = process;
+    fenwickAdd(lottery, slot, process->tickets);
+    lottery->total_tickets += process->tickets;
+}
+
+struct Process *dispatchLottery(void *state)
+{
+    struct Lottery *lottery = (struct Lottery *)state;
+    if (lottery->total_tickets == 0)
+        return NULL;
+
+    lottery->random ^= lottery->random << 13;
+    lottery->random ^= lottery->random >> 7;
+    lottery->random ^= lottery->random << 17;
+    long long winner = (long long)(lottery->random % (uint64_t)lottery->total_tickets);
+
+    // Find the slot whose ticket range holds the winner
+    int slot = 0;
+    for (int step = lottery->capacity; step > 0; step >>= 1)
+    {
+        if (slot + step <= lottery->capacity && lottery->tree[slot + step] <= winner)
+        {
+            slot += step;
+            winner -= lottery->tree[slot];
+        }
+    }
+
+    struct Process *process = lottery->slots[slot];
+    lottery->slots[slot] = NULL;
+    lottery->free_slots[lottery->free_count++] = slot;
+    fenwickAdd(lottery, slot, -process->tickets);
+    lottery->total_tickets -= process->tickets;
+    return process;
+}
+
+void destroyLottery(void *state)
+{
+    struct Lottery *lottery = (struct Lottery *)state;
+    free(lottery->slots);
+    free(lottery->tree);
+    free(lottery->free_slots);
+    free(lottery);
+}
+
+// The slots are written where they are, along with the stack of empty
+// slots, so the same tickets win after restoring; the tree is rebuilt
+void saveLottery(void *state, struct Snapshot *snapshot)
+{
+    struct Lottery *lottery = (struct Lottery *)state;
+    writeSnapshotInt(snapshot, lottery->capacity);
+    for (int i = 0; i < lottery->capacity; i++)
+    {
+        writeProcessRef(snapshot, lottery->slots[i]);
+    }
+    writeSnapshotArray(snapshot, lottery->free_slots, lottery->free_count, sizeof(int));
+    writeSnapshot(snapshot, &lottery->random, sizeof(lottery->random));
+}
+
+void restoreLottery(void *state, struct Snapshot *snapshot)
+{
+    struct Lottery *lottery = (struct Lottery *)state;
+    int capacity = readSnapshotInt(snapshot);
+    // Every slot takes room in the snapshot, which bounds the capacity
+    while (lottery->capacity < capacity && (size_t)lottery->capacity * sizeof(int) <= snapshot->length - snapshot->offset)
+        growLottery(lottery);
+    if (lottery->capacity != capacity)
+    {
+        snapshot->failed = 1;
+        return;
+    }
+
+    int used = 0;
+    for (int i = 0; i < capacity; i++)
+    {
+        lottery->slots[i] = readProcessRef(snapshot);
+        if (lottery->slots[i] != NULL)
+            used++;
+    }
+    lottery->free_count = readSnapshotRange(snapshot, 0, capacity);
+    readSnapshot(snapshot, lottery->free_slots, lottery->free_count * sizeof(int));
+    for (int i = 0; i < lottery->free_count; i++)
+    {
+        if (lottery->free_slots[i] < 0 || lottery->free_slots[i] >= capacity || lottery->slots[lottery->free_slots[i]] != NULL)
+            snapshot->failed = 1;
+    }
+    if (used + lottery->free_count != capacity)
+        snapshot->failed = 1;
+    readSnapshot(snapshot, &lottery->random, sizeof(lottery->random));
+
+    memset(lottery->tree, 0, (capacity + 1) * sizeof(long long));
+    lottery->total_tickets = 0;
+    for (int i = 0; i < capacity; i++)
+    {
+        if (lottery->slots[i] == NULL)
+            continue;
+        fenwickAdd(lottery, i, lottery->slots[i]->tickets);
+        lottery->total_tickets += lottery->slots[i]->tickets;
+    }
+}
+
+const struct SchedulerPolicy scheduler_policies[] = {
+    {"rr", createRoundRobin, enqueueRoundRobin, enqueueRoundRobin, enqueueRoundRobin, dispatchRoundRobin, finishNothing, destroyRoundRobin, saveRoundRobin, restoreRoundRobin},
+    {"srtf", createProcessHeap, enqueueShortestRemaining, enqueueShortestRemaining, enqueueShortestRemaining, dispatchShortestRemaining, finishNothing, destroyProcessHeap, saveProcessHeap, restoreProcessHeap},
+    {"mlfq", createFeedbackQueues, admitFeedback, preemptFeedback, requeueFeedback, dispatchFeedback, finishNothing, destroyFeedbackQueues, saveFeedbackQueues, restoreFeedbackQueues},
+    {"lottery", createLottery, enqueueLottery, enqueueLottery, enqueueLottery, dispatchLottery, finishNothing, destroyLottery, saveLottery, restoreLottery},
+    {"stride", createProcessHeap, admitStride, preemptStride, requeueStride, dispatchStride, finishNothing, destroyProcessHeap, saveProcessHeap, restoreProcessHeap},
+};
+
+// Function to look up a policy by name. Returns NULL if there is none.
+const struct SchedulerPolicy *findSchedulerPolicy(const char *name)
+{
+    for (size_t i = 0; i < sizeof(scheduler_policies) / sizeof(scheduler_policies[0]); i++)
+    {
+        if (strcmp(scheduler_policies[i].name, name) == 0)
+            return &scheduler_policies[i];
+    }
+    return NULL;
+}
+
+// Function to create an empty ready queue run by the policy
+struct ReadyQueue *createReadyQueue(const struct SchedulerPolicy *policy, uint64_t seed)
+{
+    struct ReadyQueue *ready = allocatePolicyState(sizeof(struct ReadyQueue));
+    ready->policy = policy;
+    ready->state = policy->create(seed);
+    ready->size = 0;
+    return ready;
+}
+
+// Function to add a newly arrived process
+void admitReady(struct ReadyQueue *ready, struct Process *process)
+{
+    ready->policy->admit(ready->state, process);
+    ready->size++;
+}
+
+// Function to hand back a process that was running or could not be started
+void preemptReady(struct ReadyQueue *ready, struct Process *process)
+{
+    ready->policy->preempt(ready->state, process);
+    ready->size++;
+}
+
+// Function to put back a process that was dispatched but did not run
+void requeueReady(struct ReadyQueue *ready, struct Process *process)
+{
+    ready->policy->requeue(ready->state, process);
+    ready->size++;
+}
+
+// Function to take the process the policy wants to run next
+struct Process *dispatchReady(struct ReadyQueue *ready)
+{
+    struct Process *process = ready->policy->dispatch(ready->state);
+    if (process != NULL)
+        ready->size--;
+    return process;
+}
+
+// Function to tell the policy a process has completed
+void finishReady(struct ReadyQueue *ready, struct Process *process)
+{
+    ready->policy->finish(ready->state, process);
+}
+
+int isReadyEmpty(struct ReadyQueue *ready)
+{
+    return ready->size == 0;
+}
+
+void freeReadyQueue(struct ReadyQueue *ready)
+{
+    ready->policy->destroy(ready->state);
+    free(ready);
+}
+
+// Function to write the ready processes into a snapshot
+void saveReadyQueue(struct Snapshot *snapshot, struct ReadyQueue *ready)
+{
+    writeSnapshotInt(snapshot, ready->size);
+    ready->policy->save(ready->state, snapshot);
+}
+
+// Function to read the ready processes written by saveReadyQueue()
+// into an empty ready queue of the same policy
+void restoreReadyQueue(struct Snapshot *snapshot, struct ReadyQueue *ready)
+{
+    ready->size = readSnapshotRange(snapshot, 0, snapshot->process_count);
+    ready->policy->restore(ready->state, snapshot);
+}
@@ -1,91 +1,131 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-// Define a structure to represent a node in the queue
-struct Node
-{
-    struct Process *data;
-    struct Node *next;
-};
+#define INITIAL_QUEUE_CAPACITY 16
 
-// Define a structure to represent the queue
+// Define a structure to represent the queue as a ring buffer of processes.
+// The buffer only grows when it is full, so once it has reached the peak
+// queue length enqueue and dequeue never touch the heap.
 struct Queue
 {
-    struct Node *front;
-    struct Node *rear;
+    struct Process **items;
+    int capacity; // Number of slots in the ring buffer
+    int front;    // Index of the first process
+    int size;     // Number of processes in the queue
 };
 
-// Function to create a new node
-struct Node *createNode(struct Process *data)
+// Function to initialize the queue
+struct Queue *createQueue()
 {
-    struct Node *newNode = (struct Node *)malloc(sizeof(struct Node));
-    if (newNode == NULL)
+    struct Queue *queue = (struct Queue *)malloc(sizeof(struct Queue));
+    if (queue == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    queue->items = (struct Process **)malloc(INITIAL_QUEUE_CAPACITY * sizeof(struct Process *));
+    if (queue->items == NULL)
     {
         fprintf(stderr, "Memory allocation failed\n");
         exit(EXIT_FAILURE);
     }
-    newNode->data = data;
-    newNode->next = NULL;
-    return newNode;
+    queue->capacity = INITIAL_QUEUE_CAPACITY;
+    queue->front = 0;
+    queue->size = 0;
+    return queue;
 }
 
-// Function to initialize the queue
-struct Queue *createQueue()
+// Function to double the ring buffer, unwrapping it to start at slot 0
+void growQueue(struct Queue *queue)
 {
-    struct Queue *queue = (struct Queue *)malloc(sizeof(struct Queue));
-    if (queue == NULL)
+    struct Process **items = (struct Process **)malloc(2 * queue->capacity * sizeof(struct Process *));
+    if (items == NULL)
     {
         fprintf(stderr, "Memory allocation failed\n");
         exit(EXIT_FAILURE);
     }
-    queue->front = queue->rear = NULL;
-    return queue;
+    for (int i = 0; i < queue->size; i++)
+    {
+        items[i] = queue->items[(queue->front + i) % queue->capacity];
+    }
+    free(queue->items);
+    queue->items = items;
+    queue->capacity *= 2;
+    queue->front = 0;
 }
 
 // Function to enqueue a process into the queue
 void enqueue(struct Queue *queue, struct Process *data)
 {
-    struct Node *newNode = createNode(data);
-    if (queue->rear == NULL)
-    {
-        queue->front = queue->rear = newNode;
-        return;
-    }
-    queue->rear->next = newNode;
-    queue->rear = newNode;
+    if (queue->size == queue->capacity)
+        growQueue(queue);
+    queue->items[(queue->front + queue->size) % queue->capacity] = data;
+    queue->size++;
 }
 
 // Function to dequeue a process from the queue
 struct Process *dequeue(struct Queue *queue)
 {
-    if (queue->front == NULL)
+    if (queue->size == 0)
         return NULL;
-    struct Node *temp = queue->front;
-    struct Process *data = temp->data;
-    queue->front = queue->front->next;
-    if (queue->front == NULL)
-        queue->rear = NULL;
-    free(temp);
+    struct Process *data = queue->items[queue->front];
+    queue->front = (queue->front + 1) % queue->capacity;
+    queue->size--;
     return data;
 }
 
 // Function to check if the queue is empty
 int isEmpty(struct Queue *queue)
 {
-    return queue->front == NULL;
+    return queue->size == 0;
 }
 
 // Function to peek at the first element of the queue
 struct Process *top(struct Queue *queue)
 {
-    if (queue->front == NULL)
+    if (queue->size == 0)
         return NULL;
-    return queue->front->data;
+    return queue->items[queue->front];
 }
 
-struct Node *popNode(struct Queue *queue)
+// Function to free the queue and its buffer
+void freeQueue(struct Queue *queue)
 {
-    if (queue->front == NULL)
-        return NULL;
-    return queue->front;
-}
\ No newline at end of file
+    free(queue->items);
+    free(queue);
+}
+
+// Function to write the processes of the queue, front first
+void saveQueue(struct Snapshot *snapshot, struct Queue *queue)
+{
+    writeSnapshotInt(snapshot, queue->size);
+    for (int i = 0; i < queue->size; i++)
+    {
+        writeProcessRef(snapshot, queue->items[(queue->front + i) % queue->capacity]);
+    }
+}
+
+// Function to append the processes written by saveQueue(). Each process
+// may appear once.
+void restoreQueue(struct Snapshot *snapshot, struct Queue *queue)
+{
+    int size = readSnapshotRange(snapshot, 0, snapshot->process_count);
+    char *seen = (char *)calloc(snapshot->process_count > 0 ? snapshot->process_count : 1, 1);
+    if (seen == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < size; i++)
+    {
+        int index = readSnapshotRange(snapshot, -1, snapshot->process_count - 1);
+        if (index == -1 || seen[index])
+            snapshot->failed = 1;
+        else
+        {
+            seen[index] = 1;
+            enqueue(queue, snapshot->processes[index]);
+        }
+    }
+    free(seen);
+}
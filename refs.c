@@ -0,0 +1,442 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define SEQUENTIAL_RUN 4     // References a sequential stream makes to a page before the next
+#define ZIPF_EXPONENT 1.0    // Skew of the zipf stream: page k is picked in proportion to 1/k^s
+#define REFERENCE_LINE_SIZE 4096
+
+// Define a list of the synthetic page-reference streams. sequential walks
+// the pages in order, a few references to each; zipf picks pages at
+// random, the low-numbered ones far more often; loop sweeps every page
+// in turn, one reference each. REF_FILE replays a list read from
+// a file.
+enum ReferencePattern
+{
+    REF_SEQUENTIAL,
+    REF_ZIPF,
+    REF_LOOP,
+    REFERENCE_PATTERNS,
+    REF_FILE = REFERENCE_PATTERNS
+};
+
+const char *reference_pattern_names[REFERENCE_PATTERNS] = {"sequential", "zipf", "loop"};
+
+// Function to look up a reference pattern by name. Returns -1 if there is none.
+int findReferencePattern(const char *name)
+{
+    for (int i = 0; i < REFERENCE_PATTERNS; i++)
+    {
+        if (strcmp(reference_pattern_names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Define a structure to represent the pages one process references, as
+// read from a references file
+struct ReferenceList
+{
+    char name[MAX_NAME_LENGTH];
+    int *pages;
+    int count;
+    int capacity;
+};
+
+// Define a structure to represent a references file: the lists of every
+// process named in it, sorted by name
+struct ReferenceTable
+{
+    struct ReferenceList *lists;
+    int count;
+    int capacity;
+};
+
+int compareReferenceLists(const void *a, const void *b)
+{
+    return strcmp(((const struct ReferenceList *)a)->name, ((const struct ReferenceList *)b)->name);
+}
+
+// Function to find the list of a process. Returns NULL if the file does
+// not name it.
+struct ReferenceList *findReferenceList(struct ReferenceTable *table, const char *name)
+{
+    struct ReferenceList key;
+    strncpy(key.name, name, MAX_NAME_LENGTH - 1);
+    key.name[MAX_NAME_LENGTH - 1] = '\0';
+    return (struct ReferenceList *)bsearch(&key, table->lists, table->count, sizeof(struct ReferenceList),
+                                           compareReferenceLists);
+}
+
+// Function to append a page to a list
+void addReference(struct ReferenceList *list, int page)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->pages = (int *)realloc(list->pages, list->capacity * sizeof(int));
+        if (list->pages == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->pages[list->count++] = page;
+}
+
+void freeReferenceTable(struct ReferenceTable *table)
+{
+    for (int i = 0; i < table->count; i++)
+    {
+        free(table->lists[i].pages);
+    }
+    free(table->lists);
+    free(table);
+}
+
+// Function to read a references file: lines of a process name followed by
+// the page numbers it references, in order. Lines naming the same process
+// add to its list. Returns NULL if the file cannot be read or is malformed.
+struct ReferenceTable *readReferenceTable(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        perror("Error opening references file");
+        return NULL;
+    }
+    struct ReferenceTable *table = (struct ReferenceTable *)calloc(1, sizeof(struct ReferenceTable));
+    if (table == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[REFERENCE_LINE_SIZE];
+    int line_number = 0;
+    int failed = 0;
+    while (!failed && fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char *cursor = strtok(line, " \t\r\n");
+        if (cursor == NULL)
+            continue;
+        if (strlen(cursor) >= MAX_NAME_LENGTH)
+        {
+            failed = 1;
+            break;
+        }
+
+        // Lines are few next to references, so the table is searched as it grows
+        struct ReferenceList *list = NULL;
+        for (int i = 0; i < table->count; i++)
+        {
+            if (strcmp(table->lists[i].name, cursor) == 0)
+                list = &table->lists[i];
+        }
+        if (list == NULL)
+        {
+            if (table->count == table->capacity)
+            {
+                table->capacity = table->capacity ? table->capacity * 2 : 16;
+                table->lists = (struct ReferenceList *)realloc(table->lists, table->capacity * sizeof(struct ReferenceList));
+                if (table->lists == NULL)
+                {
+                    fprintf(stderr, "Memory allocation failed\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            list = &table->lists[table->count++];
+            memset(list, 0, sizeof(*list));
+            strcpy(list->name, cursor);
+        }
+        while ((cursor = strtok(NULL, " \t\r\n")) != NULL)
+        {
+            char *end;
+            long page = strtol(cursor, &end, 10);
+            if (*end != '\0' || page < 0 || page > INT32_MAX)
+            {
+                failed = 1;
+                break;
+            }
+            addReference(list, (int)page);
+        }
+    }
+    fclose(file);
+    for (int i = 0; i < table->count && !failed; i++)
+    {
+        if (table->lists[i].count == 0)
+            failed = 1;
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Malformed references file %s at line %d\n", filename, line_number);
+        freeReferenceTable(table);
+        return NULL;
+    }
+    qsort(table->lists, table->count, sizeof(struct ReferenceList), compareReferenceLists);
+    return table;
+}
+
+// Define a structure to represent the page references of one process:
+// where its stream is, which of its frames holds each page, and what its
+// references have cost so far. The working set is the number of distinct
+// pages among its last window references.
+struct PageReferences
+{
+    int pattern;
+    int pages;                        // Pages of the process; references wrap into them
+    long long position;               // References made so far
+    uint64_t random;                  // xorshift64 state of the zipf stream
+    double *cdf;                      // Cumulative share of each page under zipf, NULL otherwise
+    const struct ReferenceList *list; // Pages replayed under REF_FILE
+    int *frame_of_page;               // Frame last given to each page, -1 if none
+    long long *last_use;              // Reference number of the last use of each page
+    int window;                       // References the working set looks back over
+    int *recent;                      // The last window pages referenced, as a ring
+    int *in_window;                   // How often each page appears in recent
+    int distinct;                     // Pages that appear in recent
+    long long faults;
+    long long tlb_hits;
+    long long working_set_total; // Working set summed over the quanta the process ran
+    int working_set_samples;
+    int credit;     // References made towards the next unit of running time
+    long long owed; // Ticks the stalls of its last quantum ran past the end of it
+};
+
+void *allocateReferenceArray(size_t count, size_t size)
+{
+    void *array = calloc(count > 0 ? count : 1, size);
+    if (array == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+// Function to create the stream of a process with the given number of
+// pages. list is used under REF_FILE; seed starts the zipf stream.
+struct PageReferences *createPageReferences(int pattern, int pages, const struct ReferenceList *list, uint64_t seed,
+                                            int window)
+{
+    struct PageReferences *refs = (struct PageReferences *)allocateReferenceArray(1, sizeof(struct PageReferences));
+    refs->pattern = pattern;
+    refs->pages = pages > 0 ? pages : 1;
+    refs->random = seed ? seed : 1;
+    refs->list = list;
+    refs->cdf = NULL;
+    if (pattern == REF_ZIPF)
+    {
+        refs->cdf = (double *)allocateReferenceArray(refs->pages, sizeof(double));
+        double total = 0;
+        for (int page = 0; page < refs->pages; page++)
+        {
+            total += 1.0 / pow(page + 1, ZIPF_EXPONENT);
+            refs->cdf[page] = total;
+        }
+        for (int page = 0; page < refs->pages; page++)
+        {
+            refs->cdf[page] /= total;
+        }
+    }
+    refs->frame_of_page = (int *)allocateReferenceArray(refs->pages, sizeof(int));
+    memset(refs->frame_of_page, -1, refs->pages * sizeof(int));
+    refs->last_use = (long long *)allocateReferenceArray(refs->pages, sizeof(long long));
+    refs->window = window > 0 ? window : 1;
+    refs->recent = (int *)allocateReferenceArray(refs->window, sizeof(int));
+    refs->in_window = (int *)allocateReferenceArray(refs->pages, sizeof(int));
+    return refs;
+}
+
+void freePageReferences(struct PageReferences *refs)
+{
+    free(refs->cdf);
+    free(refs->frame_of_page);
+    free(refs->last_use);
+    free(refs->recent);
+    free(refs->in_window);
+    free(refs);
+}
+
+// Function to take the next page of the stream and count it into the
+// working set
+int nextReference(struct PageReferences *refs)
+{
+    int page;
+    if (refs->pattern == REF_SEQUENTIAL)
+        page = (int)(refs->position / SEQUENTIAL_RUN % refs->pages);
+    else if (refs->pattern == REF_LOOP)
+        page = (int)(refs->position % refs->pages);
+    else if (refs->pattern == REF_FILE)
+        page = refs->list->pages[refs->position % refs->list->count] % refs->pages;
+    else
+    {
+        refs->random ^= refs->random << 13;
+        refs->random ^= refs->random >> 7;
+        refs->random ^= refs->random << 17;
+        double u = (refs->random >> 11) * (1.0 / 9007199254740992.0); // 53 random bits in [0, 1)
+        int low = 0, high = refs->pages - 1;
+        while (low < high)
+        {
+            int middle = (low + high) / 2;
+            if (refs->cdf[middle] > u)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        page = low;
+    }
+
+    // The page leaving the window is the one written window references ago
+    int slot = (int)(refs->position % refs->window);
+    if (refs->position >= refs->window && --refs->in_window[refs->recent[slot]] == 0)
+        refs->distinct--;
+    refs->recent[slot] = page;
+    if (refs->in_window[page]++ == 0)
+        refs->distinct++;
+    refs->position++;
+    refs->last_use[page] = refs->position;
+    return page;
+}
+
+// Function to write what changes as the stream runs
+void savePageReferences(struct Snapshot *snapshot, struct PageReferences *refs)
+{
+    writeSnapshotLong(snapshot, refs->position);
+    writeSnapshot(snapshot, &refs->random, sizeof(refs->random));
+    writeSnapshotArray(snapshot, refs->frame_of_page, refs->pages, sizeof(int));
+    writeSnapshotArray(snapshot, refs->last_use, refs->pages, sizeof(long long));
+    writeSnapshotArray(snapshot, refs->recent, refs->window, sizeof(int));
+    writeSnapshotArray(snapshot, refs->in_window, refs->pages, sizeof(int));
+    writeSnapshotInt(snapshot, refs->distinct);
+    writeSnapshotLong(snapshot, refs->faults);
+    writeSnapshotLong(snapshot, refs->tlb_hits);
+    writeSnapshotLong(snapshot, refs->working_set_total);
+    writeSnapshotInt(snapshot, refs->working_set_samples);
+    writeSnapshotInt(snapshot, refs->credit);
+    writeSnapshotLong(snapshot, refs->owed);
+}
+
+// Function to overwrite a stream created with the same settings with the
+// state written by savePageReferences(), in a memory of frame_count frames
+void restorePageReferences(struct Snapshot *snapshot, struct PageReferences *refs, int frame_count)
+{
+    refs->position = readSnapshotLong(snapshot);
+    readSnapshot(snapshot, &refs->random, sizeof(refs->random));
+    readSnapshotArray(snapshot, refs->frame_of_page, refs->pages, sizeof(int));
+    readSnapshotArray(snapshot, refs->last_use, refs->pages, sizeof(long long));
+    readSnapshotArray(snapshot, refs->recent, refs->window, sizeof(int));
+    readSnapshotArray(snapshot, refs->in_window, refs->pages, sizeof(int));
+    refs->distinct = readSnapshotRange(snapshot, 0, refs->pages);
+    refs->faults = readSnapshotLong(snapshot);
+    refs->tlb_hits = readSnapshotLong(snapshot);
+    refs->working_set_total = readSnapshotLong(snapshot);
+    refs->working_set_samples = readSnapshotRange(snapshot, 0, INT32_MAX);
+    refs->credit = readSnapshotInt(snapshot);
+    refs->owed = readSnapshotLong(snapshot);
+    if (refs->position < 0 || refs->credit < 0 || refs->owed < 0)
+        snapshot->failed = 1;
+    for (int page = 0; page < refs->pages; page++)
+    {
+        if (refs->in_window[page] < 0 || refs->in_window[page] > refs->window)
+            snapshot->failed = 1;
+        if (refs->frame_of_page[page] < -1 || refs->frame_of_page[page] >= frame_count)
+            snapshot->failed = 1;
+    }
+    for (int i = 0; i < refs->window; i++)
+    {
+        if (refs->recent[i] < 0 || refs->recent[i] >= refs->pages)
+            snapshot->failed = 1;
+    }
+}
+
+// Define a structure to represent the TLB of one core: sets of ways, each
+// caching the frame of one page of one process, the least recently used
+// way of a set making room for a new entry. Entries are tagged with the
+// process, so nothing is flushed when the core changes process; an entry
+// whose page has since moved to another frame, or left memory, misses.
+struct Tlb
+{
+    int sets;
+    int ways;
+    long long *keys; // Process and page of each way, -1 if it is empty
+    int *frames;
+    long long *stamps; // When each way was last used
+    long long clock;   // Lookups so far, which never wraps in a run
+};
+
+// Function to create an empty TLB of the given number of entries, which
+// is a multiple of the ways of a set
+struct Tlb *createTlb(int entries, int ways)
+{
+    struct Tlb *tlb = (struct Tlb *)allocateReferenceArray(1, sizeof(struct Tlb));
+    tlb->sets = entries / ways;
+    tlb->ways = ways;
+    tlb->keys = (long long *)allocateReferenceArray(entries, sizeof(long long));
+    memset(tlb->keys, -1, entries * sizeof(long long));
+    tlb->frames = (int *)allocateReferenceArray(entries, sizeof(int));
+    tlb->stamps = (long long *)allocateReferenceArray(entries, sizeof(long long));
+    tlb->clock = 0;
+    return tlb;
+}
+
+// Function to translate a page of a process that is now held in the
+// frame. Returns 1 on a hit; on a miss the entry is filled in.
+int tlbLookup(struct Tlb *tlb, int pid, int page, int frame)
+{
+    long long key = (long long)pid << 32 | (unsigned)page;
+    int first = (int)(((uint64_t)key * 0x9E3779B97F4A7C15ull >> 32) % (uint64_t)tlb->sets) * tlb->ways;
+    int victim = first;
+    tlb->clock++;
+    for (int way = first; way < first + tlb->ways; way++)
+    {
+        if (tlb->keys[way] == key)
+        {
+            int hit = tlb->frames[way] == frame;
+            tlb->frames[way] = frame;
+            tlb->stamps[way] = tlb->clock;
+            return hit;
+        }
+        if (tlb->keys[victim] != -1 && (tlb->keys[way] == -1 || tlb->stamps[way] < tlb->stamps[victim]))
+            victim = way;
+    }
+    tlb->keys[victim] = key;
+    tlb->frames[victim] = frame;
+    tlb->stamps[victim] = tlb->clock;
+    return 0;
+}
+
+void freeTlb(struct Tlb *tlb)
+{
+    free(tlb->keys);
+    free(tlb->frames);
+    free(tlb->stamps);
+    free(tlb);
+}
+
+// Function to write the entries of a TLB
+void saveTlb(struct Snapshot *snapshot, struct Tlb *tlb)
+{
+    writeSnapshotArray(snapshot, tlb->keys, tlb->sets * tlb->ways, sizeof(long long));
+    writeSnapshotArray(snapshot, tlb->frames, tlb->sets * tlb->ways, sizeof(int));
+    writeSnapshotArray(snapshot, tlb->stamps, tlb->sets * tlb->ways, sizeof(long long));
+    writeSnapshotLong(snapshot, tlb->clock);
+}
+
+// Function to overwrite a TLB of the same shape with the entries written
+// by saveTlb(). No way may have been used after the clock.
+void restoreTlb(struct Snapshot *snapshot, struct Tlb *tlb)
+{
+    readSnapshotArray(snapshot, tlb->keys, tlb->sets * tlb->ways, sizeof(long long));
+    readSnapshotArray(snapshot, tlb->frames, tlb->sets * tlb->ways, sizeof(int));
+    readSnapshotArray(snapshot, tlb->stamps, tlb->sets * tlb->ways, sizeof(long long));
+    tlb->clock = readSnapshotLong(snapshot);
+    for (int way = 0; way < tlb->sets * tlb->ways; way++)
+    {
+        if (tlb->stamps[way] < 0 || tlb->stamps[way] > tlb->clock)
+            snapshot->failed = 1;
+    }
+}
@@ -0,0 +1,922 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#define WORKING_SET_QUANTA 10 // Working-set window of the ws policy, in quanta
+
+// Define a structure to represent which page of which process every frame
+// holds, shared by the scheduler and the replacement policies
+struct FrameMap
+{
+    struct Process **owner; // Process holding the frame, NULL if it is free
+    int *page;              // Slot of the frame in its owner's frame list
+    int count;              // Number of frames
+    int evictable_first;    // Frames the policies may take lie in
+    int evictable_end;      // [evictable_first, evictable_end), every frame unless narrowed
+};
+
+// Define a structure to represent a page replacement policy for virtual
+// memory. load is called when a frame is given to a process, reference when
+// its process runs, evict when the policy's victim is taken away and release
+// when the process finishes. victim picks the frame to evict next, never one
+// held by the process named. expired may be NULL; otherwise it returns a
+// frame that should go even though memory is not short, or -1. save writes
+// the state into a snapshot and restore reads it back into a state just made
+// by create for the same frames, failing the snapshot unless it tracks
+// exactly the frames held in the map read with it.
+struct ReplacementPolicy
+{
+    const char *name;
+    void *(*create)(const struct FrameMap *map, int window);
+    void (*load)(void *state, int frame);
+    void (*reference)(void *state, int frame, int time);
+    void (*evict)(void *state, int frame);
+    void (*release)(void *state, int frame);
+    int (*victim)(void *state, struct Process *keep);
+    int (*expired)(void *state, int time, struct Process *keep);
+    void (*destroy)(void *state);
+    void (*save)(void *state, struct Snapshot *snapshot);
+    void (*restore)(void *state, struct Snapshot *snapshot, const struct FrameMap *map);
+};
+
+// Function to create an empty frame map for the given number of frames
+void createFrameMap(struct FrameMap *map, int frame_count)
+{
+    map->owner = (struct Process **)calloc(frame_count > 0 ? frame_count : 1, sizeof(struct Process *));
+    map->page = (int *)calloc(frame_count > 0 ? frame_count : 1, sizeof(int));
+    if (map->owner == NULL || map->page == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    map->count = frame_count;
+    map->evictable_first = 0;
+    map->evictable_end = frame_count;
+}
+
+void freeFrameMap(struct FrameMap *map)
+{
+    free(map->owner);
+    free(map->page);
+}
+
+// Function to write the owner and page of every frame
+void saveFrameMap(struct Snapshot *snapshot, struct FrameMap *map)
+{
+    writeSnapshotInt(snapshot, map->count);
+    for (int frame = 0; frame < map->count; frame++)
+    {
+        writeProcessRef(snapshot, map->owner[frame]);
+    }
+    writeSnapshotArray(snapshot, map->page, map->count, sizeof(int));
+}
+
+// Function to read the frames written by saveFrameMap() into a map of the
+// same size
+void restoreFrameMap(struct Snapshot *snapshot, struct FrameMap *map)
+{
+    if (readSnapshotInt(snapshot) != map->count)
+        snapshot->failed = 1;
+    for (int frame = 0; frame < map->count; frame++)
+    {
+        map->owner[frame] = readProcessRef(snapshot);
+    }
+    readSnapshotArray(snapshot, map->page, map->count, sizeof(int));
+}
+
+void *allocateReplacementArray(size_t count, size_t size)
+{
+    void *array = calloc(count > 0 ? count : 1, size);
+    if (array == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+// Check whether the policy may take the frame away. Pinned frames, such as
+// those of a process running on another core, are kept as well, and so
+// are frames outside the evictable range.
+int frameEvictable(const struct FrameMap *map, int frame, struct Process *keep)
+{
+    return map->owner[frame] != NULL && map->owner[frame] != keep && !framesPinned(map->owner[frame]) &&
+           frame >= map->evictable_first && frame < map->evictable_end;
+}
+
+// Define a structure to represent a doubly linked list of frames threaded
+// through prev/next arrays indexed by frame, oldest at the head
+struct FrameQueue
+{
+    int *prev;
+    int *next;
+    int head;
+    int tail;
+    int size;
+};
+
+void createFrameQueue(struct FrameQueue *queue, int frame_count)
+{
+    queue->prev = allocateReplacementArray(frame_count, sizeof(int));
+    queue->next = allocateReplacementArray(frame_count, sizeof(int));
+    queue->head = queue->tail = -1;
+    queue->size = 0;
+}
+
+void pushFrame(struct FrameQueue *queue, int frame)
+{
+    queue->prev[frame] = queue->tail;
+    queue->next[frame] = -1;
+    if (queue->tail != -1)
+        queue->next[queue->tail] = frame;
+    else
+        queue->head = frame;
+    queue->tail = frame;
+    queue->size++;
+}
+
+void unlinkFrame(struct FrameQueue *queue, int frame)
+{
+    if (queue->prev[frame] != -1)
+        queue->next[queue->prev[frame]] = queue->next[frame];
+    else
+        queue->head = queue->next[frame];
+    if (queue->next[frame] != -1)
+        queue->prev[queue->next[frame]] = queue->prev[frame];
+    else
+        queue->tail = queue->prev[frame];
+    queue->size--;
+}
+
+void freeFrameQueue(struct FrameQueue *queue)
+{
+    free(queue->prev);
+    free(queue->next);
+}
+
+void saveFrameQueue(struct Snapshot *snapshot, struct FrameQueue *queue, int frame_count)
+{
+    writeSnapshotArray(snapshot, queue->prev, frame_count, sizeof(int));
+    writeSnapshotArray(snapshot, queue->next, frame_count, sizeof(int));
+    writeSnapshotInt(snapshot, queue->head);
+    writeSnapshotInt(snapshot, queue->tail);
+    writeSnapshotInt(snapshot, queue->size);
+}
+
+// Function to count the frames held in the map
+int countHeldFrames(const struct FrameMap *map)
+{
+    int held = 0;
+    for (int frame = 0; frame < map->count; frame++)
+    {
+        held += map->owner[frame] != NULL;
+    }
+    return held;
+}
+
+// Function to read a queue written by saveFrameQueue(), which must link
+// every frame held in the map once, from head to tail
+void restoreFrameQueue(struct Snapshot *snapshot, struct FrameQueue *queue, const struct FrameMap *map)
+{
+    int frame_count = map->count;
+    readSnapshotArray(snapshot, queue->prev, frame_count, sizeof(int));
+    readSnapshotArray(snapshot, queue->next, frame_count, sizeof(int));
+    queue->head = readSnapshotRange(snapshot, -1, frame_count - 1);
+    queue->tail = readSnapshotRange(snapshot, -1, frame_count - 1);
+    queue->size = readSnapshotRange(snapshot, 0, frame_count);
+
+    // A frame is reached only from the one before it, so the queue cannot loop
+    int length = 0;
+    int previous = -1;
+    for (int frame = queue->head; frame != -1; frame = queue->next[frame])
+    {
+        if (frame < 0 || frame >= frame_count || map->owner[frame] == NULL || queue->prev[frame] != previous)
+        {
+            snapshot->failed = 1;
+            break;
+        }
+        previous = frame;
+        length++;
+    }
+    if (previous != queue->tail || length != queue->size || length != countHeldFrames(map))
+        snapshot->failed = 1;
+}
+
+// ---- Clock (second chance): a hand sweeps the frames, clearing reference
+// bits, and takes the first frame whose bit is already clear ----
+
+struct ClockReplacer
+{
+    const struct FrameMap *map;
+    unsigned char *referenced;
+    int hand;
+};
+
+void *createClock(const struct FrameMap *map, int window)
+{
+    struct ClockReplacer *clock = allocateReplacementArray(1, sizeof(struct ClockReplacer));
+    clock->map = map;
+    clock->referenced = allocateReplacementArray(map->count, 1);
+    clock->hand = 0;
+    return clock;
+}
+
+void setClockBit(void *state, int frame)
+{
+    ((struct ClockReplacer *)state)->referenced[frame] = 1;
+}
+
+void referenceClock(void *state, int frame, int time)
+{
+    setClockBit(state, frame);
+}
+
+void clearClockBit(void *state, int frame)
+{
+    ((struct ClockReplacer *)state)->referenced[frame] = 0;
+}
+
+int clockVictim(void *state, struct Process *keep)
+{
+    struct ClockReplacer *clock = (struct ClockReplacer *)state;
+    // Two sweeps are enough: the first clears every bit it passes
+    for (int step = 0; step < 2 * clock->map->count; step++)
+    {
+        int frame = clock->hand;
+        clock->hand = (clock->hand + 1) % clock->map->count;
+        if (!frameEvictable(clock->map, frame, keep))
+            continue;
+        if (!clock->referenced[frame])
+            return frame;
+        clock->referenced[frame] = 0;
+    }
+    return -1;
+}
+
+void destroyClock(void *state)
+{
+    free(((struct ClockReplacer *)state)->referenced);
+    free(state);
+}
+
+void saveClock(void *state, struct Snapshot *snapshot)
+{
+    struct ClockReplacer *clock = (struct ClockReplacer *)state;
+    writeSnapshotArray(snapshot, clock->referenced, clock->map->count, 1);
+    writeSnapshotInt(snapshot, clock->hand);
+}
+
+void restoreClock(void *state, struct Snapshot *snapshot, const struct FrameMap *map)
+{
+    struct ClockReplacer *clock = (struct ClockReplacer *)state;
+    readSnapshotArray(snapshot, clock->referenced, clock->map->count, 1);
+    clock->hand = readSnapshotRange(snapshot, 0, clock->map->count > 0 ? clock->map->count - 1 : 0);
+}
+
+// ---- LFU: frames sit in buckets of equal reference count, kept in
+// ascending order, so a reference moves a frame one bucket along and the
+// victim is the oldest frame of the first bucket ----
+
+struct LfuBucket
+{
+    long long count;
+    int head; // Oldest frame in the bucket
+    int tail;
+    int prev; // Neighbouring buckets, in ascending count
+    int next;
+};
+
+struct LfuReplacer
+{
+    const struct FrameMap *map;
+    struct LfuBucket *buckets; // Pool of frame_count + 1 buckets
+    int first;                 // Bucket with the lowest count, -1 if none
+    int free_bucket;           // Stack of unused buckets, linked through next
+    int *bucket;               // Bucket of each resident frame
+    int *prev;                 // Neighbours of the frame inside its bucket
+    int *next;
+};
+
+void *createLfu(const struct FrameMap *map, int window)
+{
+    struct LfuReplacer *lfu = allocateReplacementArray(1, sizeof(struct LfuReplacer));
+    lfu->map = map;
+    lfu->buckets = allocateReplacementArray(map->count + 1, sizeof(struct LfuBucket));
+    lfu->bucket = allocateReplacementArray(map->count, sizeof(int));
+    lfu->prev = allocateReplacementArray(map->count, sizeof(int));
+    lfu->next = allocateReplacementArray(map->count, sizeof(int));
+    lfu->first = -1;
+    lfu->free_bucket = -1;
+    for (int i = map->count; i >= 0; i--)
+    {
+        lfu->buckets[i].next = lfu->free_bucket;
+        lfu->free_bucket = i;
+    }
+    return lfu;
+}
+
+// Add an empty bucket after the given one (-1 for the front)
+int insertLfuBucket(struct LfuReplacer *lfu, int after, long long count)
+{
+    int index = lfu->free_bucket;
+    struct LfuBucket *bucket = &lfu->buckets[index];
+    lfu->free_bucket = bucket->next;
+    bucket->count = count;
+    bucket->head = bucket->tail = -1;
+    bucket->prev = after;
+    bucket->next = after == -1 ? lfu->first : lfu->buckets[after].next;
+    if (bucket->next != -1)
+        lfu->buckets[bucket->next].prev = index;
+    if (after == -1)
+        lfu->first = index;
+    else
+        lfu->buckets[after].next = index;
+    return index;
+}
+
+void pushLfuFrame(struct LfuReplacer *lfu, int index, int frame)
+{
+    struct LfuBucket *bucket = &lfu->buckets[index];
+    lfu->bucket[frame] = index;
+    lfu->prev[frame] = bucket->tail;
+    lfu->next[frame] = -1;
+    if (bucket->tail != -1)
+        lfu->next[bucket->tail] = frame;
+    else
+        bucket->head = frame;
+    bucket->tail = frame;
+}
+
+// Take the frame out of its bucket, dropping the bucket once it is empty
+void unlinkLfuFrame(void *state, int frame)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    int index = lfu->bucket[frame];
+    struct LfuBucket *bucket = &lfu->buckets[index];
+    if (lfu->prev[frame] != -1)
+        lfu->next[lfu->prev[frame]] = lfu->next[frame];
+    else
+        bucket->head = lfu->next[frame];
+    if (lfu->next[frame] != -1)
+        lfu->prev[lfu->next[frame]] = lfu->prev[frame];
+    else
+        bucket->tail = lfu->prev[frame];
+    if (bucket->head != -1)
+        return;
+
+    if (bucket->prev != -1)
+        lfu->buckets[bucket->prev].next = bucket->next;
+    else
+        lfu->first = bucket->next;
+    if (bucket->next != -1)
+        lfu->buckets[bucket->next].prev = bucket->prev;
+    bucket->next = lfu->free_bucket;
+    lfu->free_bucket = index;
+}
+
+void loadLfu(void *state, int frame)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    int index = lfu->first;
+    if (index == -1 || lfu->buckets[index].count != 0)
+        index = insertLfuBucket(lfu, -1, 0);
+    pushLfuFrame(lfu, index, frame);
+}
+
+void referenceLfu(void *state, int frame, int time)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    int index = lfu->bucket[frame];
+    long long count = lfu->buckets[index].count + 1;
+    int target = lfu->buckets[index].next;
+    if (target == -1 || lfu->buckets[target].count != count)
+        target = insertLfuBucket(lfu, index, count);
+    unlinkLfuFrame(lfu, frame);
+    pushLfuFrame(lfu, target, frame);
+}
+
+int lfuVictim(void *state, struct Process *keep)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    for (int index = lfu->first; index != -1; index = lfu->buckets[index].next)
+    {
+        for (int frame = lfu->buckets[index].head; frame != -1; frame = lfu->next[frame])
+        {
+            if (frameEvictable(lfu->map, frame, keep))
+                return frame;
+        }
+    }
+    return -1;
+}
+
+void destroyLfu(void *state)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    free(lfu->buckets);
+    free(lfu->bucket);
+    free(lfu->prev);
+    free(lfu->next);
+    free(lfu);
+}
+
+void saveLfu(void *state, struct Snapshot *snapshot)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    int count = lfu->map->count;
+    writeSnapshotArray(snapshot, lfu->buckets, count + 1, sizeof(struct LfuBucket));
+    writeSnapshotInt(snapshot, lfu->first);
+    writeSnapshotInt(snapshot, lfu->free_bucket);
+    writeSnapshotArray(snapshot, lfu->bucket, count, sizeof(int));
+    writeSnapshotArray(snapshot, lfu->prev, count, sizeof(int));
+    writeSnapshotArray(snapshot, lfu->next, count, sizeof(int));
+}
+
+// Function to read the buckets written by saveLfu(). The buckets in use
+// must run in ascending count, each holding at least one frame, and hold
+// every frame of the map once; every other bucket must be on the stack of
+// unused ones.
+void restoreLfu(void *state, struct Snapshot *snapshot, const struct FrameMap *map)
+{
+    struct LfuReplacer *lfu = (struct LfuReplacer *)state;
+    int count = lfu->map->count;
+    readSnapshotArray(snapshot, lfu->buckets, count + 1, sizeof(struct LfuBucket));
+    lfu->first = readSnapshotRange(snapshot, -1, count);
+    lfu->free_bucket = readSnapshotRange(snapshot, -1, count);
+    readSnapshotArray(snapshot, lfu->bucket, count, sizeof(int));
+    readSnapshotArray(snapshot, lfu->prev, count, sizeof(int));
+    readSnapshotArray(snapshot, lfu->next, count, sizeof(int));
+    if (snapshot->failed)
+        return;
+
+    unsigned char *seen = allocateReplacementArray(count + 1, 1);
+    int buckets = 0;
+    int frames = 0;
+    int previous = -1;
+    for (int index = lfu->first; index != -1 && !snapshot->failed; index = lfu->buckets[index].next)
+    {
+        struct LfuBucket *bucket = &lfu->buckets[index];
+        if (index < 0 || index > count || bucket->prev != previous || bucket->head == -1 || bucket->count < 0 ||
+            (previous != -1 && bucket->count <= lfu->buckets[previous].count))
+        {
+            snapshot->failed = 1;
+            break;
+        }
+        seen[index] = 1;
+        buckets++;
+        previous = index;
+
+        int previous_frame = -1;
+        for (int frame = bucket->head; frame != -1; frame = lfu->next[frame])
+        {
+            if (frame < 0 || frame >= count || map->owner[frame] == NULL || lfu->bucket[frame] != index ||
+                lfu->prev[frame] != previous_frame)
+            {
+                snapshot->failed = 1;
+                break;
+            }
+            previous_frame = frame;
+            frames++;
+        }
+        if (previous_frame != bucket->tail)
+            snapshot->failed = 1;
+    }
+    for (int index = lfu->free_bucket; index != -1 && !snapshot->failed; index = lfu->buckets[index].next)
+    {
+        if (index < 0 || index > count || seen[index])
+        {
+            snapshot->failed = 1;
+            break;
+        }
+        seen[index] = 1;
+        buckets++;
+    }
+    if (buckets != count + 1 || frames != countHeldFrames(map))
+        snapshot->failed = 1;
+    free(seen);
+}
+
+// ---- ARC: resident pages seen once (T1) or more (T2), plus ghost lists of
+// pages recently evicted from each (B1, B2). A page that comes back while
+// still remembered in a ghost list shifts the target size p of T1 towards
+// the list it was evicted from. Pages are named by owner pid and slot. ----
+
+#define ARC_T1 0
+#define ARC_T2 1
+#define ARC_B1 2
+#define ARC_B2 3
+
+struct ArcEntry
+{
+    uint64_t key;  // pid << 32 | slot
+    int frame;     // Frame holding the page, -1 for a ghost
+    int list;
+    int prev;      // Neighbours in the list, LRU end at the head
+    int next;
+    int hash_next; // Next entry in the same hash chain
+};
+
+struct ArcReplacer
+{
+    const struct FrameMap *map;
+    struct ArcEntry *entries; // Pool of 2 * frame_count entries
+    int free_entry;           // Stack of unused entries, linked through next
+    int head[4];
+    int tail[4];
+    int size[4];
+    int *hash;                // Chains of entries by key
+    int hash_mask;
+    int *frame_entry;         // Entry of each resident frame
+    int capacity;             // Number of frames, c in the ARC paper
+    int target;               // Target size of T1, p in the ARC paper
+};
+
+uint64_t arcKey(const struct FrameMap *map, int frame)
+{
+    return (uint64_t)(uint32_t)map->owner[frame]->pid << 32 | (uint32_t)map->page[frame];
+}
+
+int arcHash(struct ArcReplacer *arc, uint64_t key)
+{
+    key *= 0x9E3779B97F4A7C15ull;
+    return (int)(key >> 32) & arc->hash_mask;
+}
+
+void *createArc(const struct FrameMap *map, int window)
+{
+    struct ArcReplacer *arc = allocateReplacementArray(1, sizeof(struct ArcReplacer));
+    int entry_count = 2 * map->count;
+    arc->map = map;
+    arc->entries = allocateReplacementArray(entry_count, sizeof(struct ArcEntry));
+    arc->free_entry = -1;
+    for (int i = entry_count - 1; i >= 0; i--)
+    {
+        arc->entries[i].next = arc->free_entry;
+        arc->free_entry = i;
+    }
+    for (int list = 0; list < 4; list++)
+    {
+        arc->head[list] = arc->tail[list] = -1;
+        arc->size[list] = 0;
+    }
+    int buckets = 1;
+    while (buckets < entry_count)
+        buckets *= 2;
+    arc->hash = allocateReplacementArray(buckets, sizeof(int));
+    memset(arc->hash, -1, buckets * sizeof(int));
+    arc->hash_mask = buckets - 1;
+    arc->frame_entry = allocateReplacementArray(map->count, sizeof(int));
+    arc->capacity = map->count;
+    arc->target = 0;
+    return arc;
+}
+
+void pushArcEntry(struct ArcReplacer *arc, int list, int index)
+{
+    struct ArcEntry *entry = &arc->entries[index];
+    entry->list = list;
+    entry->prev = arc->tail[list];
+    entry->next = -1;
+    if (arc->tail[list] != -1)
+        arc->entries[arc->tail[list]].next = index;
+    else
+        arc->head[list] = index;
+    arc->tail[list] = index;
+    arc->size[list]++;
+}
+
+void unlinkArcEntry(struct ArcReplacer *arc, int index)
+{
+    struct ArcEntry *entry = &arc->entries[index];
+    if (entry->prev != -1)
+        arc->entries[entry->prev].next = entry->next;
+    else
+        arc->head[entry->list] = entry->next;
+    if (entry->next != -1)
+        arc->entries[entry->next].prev = entry->prev;
+    else
+        arc->tail[entry->list] = entry->prev;
+    arc->size[entry->list]--;
+}
+
+// Unlink the entry and forget its key
+void dropArcEntry(struct ArcReplacer *arc, int index)
+{
+    unlinkArcEntry(arc, index);
+    int *link = &arc->hash[arcHash(arc, arc->entries[index].key)];
+    while (*link != index)
+        link = &arc->entries[*link].hash_next;
+    *link = arc->entries[index].hash_next;
+    arc->entries[index].next = arc->free_entry;
+    arc->free_entry = index;
+}
+
+int findArcEntry(struct ArcReplacer *arc, uint64_t key)
+{
+    int index = arc->hash[arcHash(arc, key)];
+    while (index != -1 && arc->entries[index].key != key)
+        index = arc->entries[index].hash_next;
+    return index;
+}
+
+void loadArc(void *state, int frame)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    uint64_t key = arcKey(arc->map, frame);
+    int index = findArcEntry(arc, key);
+    if (index != -1)
+    {
+        // A ghost hit: grow the list that would have kept the page
+        struct ArcEntry *entry = &arc->entries[index];
+        if (entry->list == ARC_B1)
+        {
+            int delta = arc->size[ARC_B2] > arc->size[ARC_B1] ? arc->size[ARC_B2] / arc->size[ARC_B1] : 1;
+            arc->target = arc->target + delta < arc->capacity ? arc->target + delta : arc->capacity;
+        }
+        else
+        {
+            int delta = arc->size[ARC_B1] > arc->size[ARC_B2] ? arc->size[ARC_B1] / arc->size[ARC_B2] : 1;
+            arc->target = arc->target > delta ? arc->target - delta : 0;
+        }
+        unlinkArcEntry(arc, index);
+        pushArcEntry(arc, ARC_T2, index);
+    }
+    else
+    {
+        // Keep T1 + B1 within c and the whole directory within 2c
+        int directory = arc->size[ARC_T1] + arc->size[ARC_T2] + arc->size[ARC_B1] + arc->size[ARC_B2];
+        if (arc->size[ARC_T1] + arc->size[ARC_B1] >= arc->capacity && arc->size[ARC_B1] > 0)
+            dropArcEntry(arc, arc->head[ARC_B1]);
+        else if (directory >= 2 * arc->capacity && arc->size[ARC_B2] > 0)
+            dropArcEntry(arc, arc->head[ARC_B2]);
+        else if (arc->free_entry == -1)
+            dropArcEntry(arc, arc->head[arc->size[ARC_B1] > 0 ? ARC_B1 : ARC_B2]);
+
+        index = arc->free_entry;
+        arc->free_entry = arc->entries[index].next;
+        arc->entries[index].key = key;
+        int bucket = arcHash(arc, key);
+        arc->entries[index].hash_next = arc->hash[bucket];
+        arc->hash[bucket] = index;
+        pushArcEntry(arc, ARC_T1, index);
+    }
+    arc->entries[index].frame = frame;
+    arc->frame_entry[frame] = index;
+}
+
+void referenceArc(void *state, int frame, int time)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    int index = arc->frame_entry[frame];
+    unlinkArcEntry(arc, index);
+    pushArcEntry(arc, ARC_T2, index);
+}
+
+void evictArc(void *state, int frame)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    int index = arc->frame_entry[frame];
+    int ghost = arc->entries[index].list == ARC_T1 ? ARC_B1 : ARC_B2;
+    unlinkArcEntry(arc, index);
+    arc->entries[index].frame = -1;
+    pushArcEntry(arc, ghost, index);
+}
+
+void releaseArc(void *state, int frame)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    dropArcEntry(arc, arc->frame_entry[frame]);
+}
+
+int arcVictimIn(struct ArcReplacer *arc, int list, struct Process *keep)
+{
+    for (int index = arc->head[list]; index != -1; index = arc->entries[index].next)
+    {
+        if (frameEvictable(arc->map, arc->entries[index].frame, keep))
+            return arc->entries[index].frame;
+    }
+    return -1;
+}
+
+int arcVictim(void *state, struct Process *keep)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    // Take from T1 while it is over its target, otherwise from T2
+    int first = arc->size[ARC_T1] > 0 && arc->size[ARC_T1] > arc->target ? ARC_T1 : ARC_T2;
+    int frame = arcVictimIn(arc, first, keep);
+    if (frame == -1)
+        frame = arcVictimIn(arc, first == ARC_T1 ? ARC_T2 : ARC_T1, keep);
+    return frame;
+}
+
+void destroyArc(void *state)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    free(arc->entries);
+    free(arc->hash);
+    free(arc->frame_entry);
+    free(arc);
+}
+
+void saveArc(void *state, struct Snapshot *snapshot)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    writeSnapshotArray(snapshot, arc->entries, 2 * arc->capacity, sizeof(struct ArcEntry));
+    writeSnapshotInt(snapshot, arc->free_entry);
+    writeSnapshotArray(snapshot, arc->head, 4, sizeof(int));
+    writeSnapshotArray(snapshot, arc->tail, 4, sizeof(int));
+    writeSnapshotArray(snapshot, arc->size, 4, sizeof(int));
+    writeSnapshotArray(snapshot, arc->hash, arc->hash_mask + 1, sizeof(int));
+    writeSnapshotArray(snapshot, arc->frame_entry, arc->capacity, sizeof(int));
+    writeSnapshotInt(snapshot, arc->target);
+}
+
+// Function to read the lists written by saveArc(). T1 and T2 must hold an
+// entry for every frame of the map, B1 and B2 only ghosts, every entry in
+// a list must be in the hash chain of its key and every other entry must
+// be on the stack of unused ones.
+void restoreArc(void *state, struct Snapshot *snapshot, const struct FrameMap *map)
+{
+    struct ArcReplacer *arc = (struct ArcReplacer *)state;
+    int entry_count = 2 * arc->capacity;
+    readSnapshotArray(snapshot, arc->entries, entry_count, sizeof(struct ArcEntry));
+    arc->free_entry = readSnapshotRange(snapshot, -1, entry_count - 1);
+    readSnapshotArray(snapshot, arc->head, 4, sizeof(int));
+    readSnapshotArray(snapshot, arc->tail, 4, sizeof(int));
+    readSnapshotArray(snapshot, arc->size, 4, sizeof(int));
+    readSnapshotArray(snapshot, arc->hash, arc->hash_mask + 1, sizeof(int));
+    readSnapshotArray(snapshot, arc->frame_entry, arc->capacity, sizeof(int));
+    arc->target = readSnapshotRange(snapshot, 0, arc->capacity);
+    if (snapshot->failed)
+        return;
+
+    unsigned char *seen = allocateReplacementArray(entry_count, 1); // 1 in a list, 2 hashed too, 3 unused
+    int listed = 0;
+    int resident = 0;
+    for (int list = 0; list < 4 && !snapshot->failed; list++)
+    {
+        int length = 0;
+        int previous = -1;
+        for (int index = arc->head[list]; index != -1 && !snapshot->failed; index = arc->entries[index].next)
+        {
+            struct ArcEntry *entry = index >= 0 && index < entry_count ? &arc->entries[index] : NULL;
+            if (entry == NULL || entry->list != list || entry->prev != previous)
+            {
+                snapshot->failed = 1;
+                break;
+            }
+            if (list == ARC_T1 || list == ARC_T2)
+            {
+                if (entry->frame < 0 || entry->frame >= arc->capacity || map->owner[entry->frame] == NULL ||
+                    arc->frame_entry[entry->frame] != index || entry->key != arcKey(map, entry->frame))
+                    snapshot->failed = 1;
+                resident++;
+            }
+            else if (entry->frame != -1)
+                snapshot->failed = 1;
+            seen[index] = 1;
+            previous = index;
+            length++;
+        }
+        if (previous != arc->tail[list] || length != arc->size[list])
+            snapshot->failed = 1;
+        listed += length;
+    }
+    if (resident != countHeldFrames(map))
+        snapshot->failed = 1;
+
+    int hashed = 0;
+    for (int bucket = 0; bucket <= arc->hash_mask && !snapshot->failed; bucket++)
+    {
+        for (int index = arc->hash[bucket]; index != -1; index = arc->entries[index].hash_next)
+        {
+            if (index < 0 || index >= entry_count || seen[index] != 1 || arcHash(arc, arc->entries[index].key) != bucket)
+            {
+                snapshot->failed = 1;
+                break;
+            }
+            seen[index] = 2;
+            hashed++;
+        }
+    }
+    int unused = 0;
+    for (int index = arc->free_entry; index != -1 && !snapshot->failed; index = arc->entries[index].next)
+    {
+        if (index < 0 || index >= entry_count || seen[index] != 0)
+        {
+            snapshot->failed = 1;
+            break;
+        }
+        seen[index] = 3;
+        unused++;
+    }
+    if (hashed != listed || listed + unused != entry_count)
+        snapshot->failed = 1;
+    free(seen);
+}
+
+// ---- Working set: frames in order of last reference. Frames not
+// referenced within the window have left their process's working set and
+// are released whenever memory is needed, even beyond what was asked for;
+// if that is not enough the least recently referenced frames go. ----
+
+struct WorkingSetReplacer
+{
+    const struct FrameMap *map;
+    struct FrameQueue order; // Least recently referenced at the head
+    int *last_use;           // Time of the last reference of each frame
+    int window;              // Working-set window in time units
+};
+
+void *createWorkingSet(const struct FrameMap *map, int window)
+{
+    struct WorkingSetReplacer *set = allocateReplacementArray(1, sizeof(struct WorkingSetReplacer));
+    set->map = map;
+    createFrameQueue(&set->order, map->count);
+    set->last_use = allocateReplacementArray(map->count, sizeof(int));
+    set->window = window;
+    return set;
+}
+
+void loadWorkingSet(void *state, int frame)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    set->last_use[frame] = INT_MIN;
+    pushFrame(&set->order, frame);
+}
+
+void referenceWorkingSet(void *state, int frame, int time)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    set->last_use[frame] = time;
+    unlinkFrame(&set->order, frame);
+    pushFrame(&set->order, frame);
+}
+
+void unlinkWorkingSet(void *state, int frame)
+{
+    unlinkFrame(&((struct WorkingSetReplacer *)state)->order, frame);
+}
+
+int workingSetVictim(void *state, struct Process *keep)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    for (int frame = set->order.head; frame != -1; frame = set->order.next[frame])
+    {
+        if (frameEvictable(set->map, frame, keep))
+            return frame;
+    }
+    return -1;
+}
+
+int workingSetExpired(void *state, int time, struct Process *keep)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    for (int frame = set->order.head; frame != -1 && set->last_use[frame] <= time - set->window; frame = set->order.next[frame])
+    {
+        if (frameEvictable(set->map, frame, keep))
+            return frame;
+    }
+    return -1;
+}
+
+void destroyWorkingSet(void *state)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    freeFrameQueue(&set->order);
+    free(set->last_use);
+    free(set);
+}
+
+void saveWorkingSet(void *state, struct Snapshot *snapshot)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    saveFrameQueue(snapshot, &set->order, set->map->count);
+    writeSnapshotArray(snapshot, set->last_use, set->map->count, sizeof(int));
+}
+
+void restoreWorkingSet(void *state, struct Snapshot *snapshot, const struct FrameMap *map)
+{
+    struct WorkingSetReplacer *set = (struct WorkingSetReplacer *)state;
+    restoreFrameQueue(snapshot, &set->order, map);
+    readSnapshotArray(snapshot, set->last_use, set->map->count, sizeof(int));
+}
+
+const struct ReplacementPolicy replacement_policies[] = {
+    {"clock", createClock, setClockBit, referenceClock, clearClockBit, clearClockBit, clockVictim, NULL, destroyClock, saveClock, restoreClock},
+    {"lfu", createLfu, loadLfu, referenceLfu, unlinkLfuFrame, unlinkLfuFrame, lfuVictim, NULL, destroyLfu, saveLfu, restoreLfu},
+    {"arc", createArc, loadArc, referenceArc, evictArc, releaseArc, arcVictim, NULL, destroyArc, saveArc, restoreArc},
+    {"ws", createWorkingSet, loadWorkingSet, referenceWorkingSet, unlinkWorkingSet, unlinkWorkingSet, workingSetVictim, workingSetExpired, destroyWorkingSet, saveWorkingSet, restoreWorkingSet},
+};
+
+// Function to look up a replacement policy by name. Returns NULL if there is none.
+const struct ReplacementPolicy *findReplacementPolicy(const char *name)
+{
+    for (size_t i = 0; i < sizeof(replacement_policies) / sizeof(replacement_policies[0]); i++)
+    {
+        if (strcmp(replacement_policies[i].name, name) == 0)
+            return &replacement_policies[i];
+    }
+    return NULL;
+}
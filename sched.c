@@ -0,0 +1,2652 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include "sched.h"
+#include "snapshot.c"
+#include "queue.c"
+#include "extent.c"
+#include "buddy.c"
+#include "frames.c"
+#include "numa.c"
+#include "trace.c"
+#include "refs.c"
+#include "convert.c"
+#include "output.c"
+#include "stats.c"
+#include "metrics.c"
+
+#define DEFAULT_MEMORY_SIZE 2048 // Memory size in KB unless configured
+#define DEFAULT_PAGE_SIZE 4       // Page size in KB unless configured
+#define MIN_RESIDENT_PAGES 4 // Pages a virtual-memory process needs resident to run
+#define IS_VIRTUAL 1
+#define NOT_VIRTUAL 0
+
+typedef enum
+{
+    UNREADY,
+    READY,
+    RUNNING,
+    BLOCKED, // Waiting for its pages to be brought in
+    FINISHED
+} ProcessStatus;
+
+typedef struct Process
+{
+    int pid;
+    char name[MAX_NAME_LENGTH];        // Process Name
+    int arrival_time;                  // Arrival time
+    int remaining_time;                // Remaining execution time
+    ProcessStatus status;              // Status of the process
+    int memory_executed_proc_arr_size; // Required memory usage in KB
+    int memory_start_address;          // Indicate the start adress of the memory; -1 if the memory is not allocated
+    struct FrameList frames;           // Frame slots of the process; evicted slots are empty
+    int total_page;
+    int sum_remaining_time;
+    int total_time;
+    struct Process *executed_prev;     // Previous process in the executed order, NULL at the front
+    struct Process *executed_next;     // Next process in the executed order, NULL at the rear
+    int in_executed_list;              // 1 if the process is linked into the executed order
+    int level;                         // Queue level under the mlfq policy
+    int boost_epoch;                   // Boosts of its mlfq queues before it was last queued
+    int tickets;                       // Share of the CPU under the lottery and stride policies
+    long long pass;                    // Virtual time under the stride policy
+    int live_index;                    // Position in the table of live processes
+    int core;                          // Core the process last ran on, -1 before it first runs
+    int node;                          // NUMA node whose frames it prefers, that of the core it arrived on
+    int ready_at;                      // Time the pages it blocked on are in, -1 once it has run with them
+    struct PageReferences *refs;       // Pages it references as it runs, NULL without reference streams
+} Process;
+
+// Check whether the frames of a process have to stay where they are: it
+// is running, or it blocked for pages it has not run with yet
+int framesPinned(const Process *process)
+{
+    return process->status == RUNNING || process->ready_at != -1;
+}
+
+#include "policy.c"
+#include "replace.c"
+
+struct Simulation;
+
+// Define a structure to represent one CPU: the process it runs and the
+// ready queue it picks from
+struct Core
+{
+    Process *current_process; // Process given the last quantum, NULL if none
+    struct ReadyQueue *ready_processes;
+    long long busy_time; // Time spent running processes
+    struct RunningStats turnaround_stats; // Over the processes that finished on this core
+    struct RunningStats overhead_stats;
+    struct RunningStats wait_stats;
+};
+
+// Define a structure to represent the page a frame holds under reference
+// streams; pid is -1 while the frame is empty
+struct FramePage
+{
+    int pid;
+    int page;
+};
+
+// Define a structure to represent a memory strategy. allocate returns 1
+// once the process holds memory and 0 if it has to wait; release gives the
+// memory back when the process finishes; print_usage appends the memory
+// fields of a RUNNING line. Strategies whose allocation can fail also say
+// whether a request of a given size would succeed now (fits) and whether
+// it could ever succeed (fits_empty); both are NULL for the others.
+// uses_frames is 1 for the strategies that hand out frames, and is_virtual
+// for the one that brings pages in as processes run. holders_valid checks
+// a restored run: it returns 1 if no memory a process holds is also free
+// or held by another process, and is NULL when there is nothing to hold.
+struct MemoryStrategy
+{
+    const char *name;
+    int (*allocate)(struct Simulation *sim, Process *process);
+    void (*release)(struct Simulation *sim, Process *process);
+    void (*print_usage)(struct Simulation *sim, Process *process);
+    int (*fits)(struct Simulation *sim, int size);
+    int (*fits_empty)(struct Simulation *sim, int size);
+    int (*holders_valid)(struct Simulation *sim);
+    int uses_frames;
+    int is_virtual;
+};
+
+typedef struct
+{
+    struct ExtentTree *free_extents; // Holes in the memory ordered by start address
+    int next_fit_cursor;             // Where next-fit resumes its search
+    struct BuddyAllocator *buddy;    // Free blocks for -m buddy, created on first use
+} ContiguousMemory;
+
+// Define a structure to represent one simulation. The settings are
+// resolved from a sched_config when it is created; the rest is the state
+// of the run, so several simulations can go on side by side.
+struct Simulation
+{
+    const struct MemoryStrategy *memory_strategy; // Resolved in configureSimulation()
+    int quantum_time;
+    int memory_size;                                // Total memory in KB
+    int page_size;                                  // Size of a page/frame in KB
+    int page_num;                                   // Number of frames in the memory
+    int frames_as_ranges;                           // 1 to print frame lists as ranges (--frames=ranges)
+    const struct SchedulerPolicy *scheduler_policy; // Picks the next process to run (-s)
+    uint64_t policy_seed;                           // Seed for randomised policies (-S)
+    const struct ReplacementPolicy *replacement_policy; // Per-frame replacement for virtual (-r); NULL evicts whole processes
+    int report_evictions;                           // 1 to print the eviction count (-r given)
+    int report_skipped;                             // 1 to say on stderr which processes were too large
+    int core_count;                                 // Number of CPUs (-c)
+    int migration_cost;                             // Time a process loses when it runs on a different core
+    int node_count;                                 // NUMA nodes the frames are split into (--nodes)
+    int numa_policy;                                // How frames are spread over the nodes (--numa-policy)
+    int remote_cost;                                // Part of a quantum lost by a process with every frame on other nodes
+    int fault_cost;                                 // Time to bring one page into a frame under virtual
+    int writeback_cost;                             // Time to write back one dirty frame before it is evicted
+    int switch_cost;                                // Time every decision in which a core changes process takes
+    int reference_pattern;                          // Stream of the processes not in the references file, -1 for no streams
+    struct ReferenceTable *reference_table;         // Read from the references file, NULL if there is none
+    const char *references_file;                    // Name of that file, "" if there is none
+    int reference_rate;                             // References a process makes per unit of running time
+    int tlb_entries;                                // Entries of the TLB of every core
+    int tlb_ways;                                   // Ways of each set of the TLB
+
+    int current_time;
+    int process_count; // Number of admitted processes that have not finished
+    int memory_usage;
+    struct FramePools *page_table; // Allocated frames of every NUMA node
+    int total_process;
+    int make_span;
+    int total_turnover;
+    struct TraceReader *trace; // Processes that have not arrived yet, read on demand
+    struct OutputSink *output; // Buffered writer for the event lines
+    int next_pid;
+    struct Core *cores; // One per CPU, each with its own ready queue
+    void *replacement_state;
+    struct FrameMap frame_map;   // Owner of every frame, kept while a replacement policy is in use
+    int evicted_frame_count;     // Frames taken from processes that had not finished
+    struct RunningStats turnaround_stats; // Over every finished process, merged from the cores at the end
+    struct RunningStats overhead_stats;   // Over the finished processes with a positive overhead
+    struct RunningStats wait_stats;
+    int report_percentiles;               // 1 to print the spread of each measure in the summary
+    int context_switch_count;             // Times a core was given to a different process
+    int migration_count;                  // Times a process ran on a different core than before
+    int remote_time;                      // Running time processes lost to their frames on other nodes
+    int page_fault_count;                 // Pages brought into frames under virtual
+    int writeback_count;                  // Dirty frames written back as they were evicted
+    int switch_time;                      // Time spent changing the process of a core
+    struct Queue *blocked_processes;      // Processes waiting for their pages, in the order they blocked
+    unsigned char *dirty_frames;          // 1 for every frame written since it was loaded, NULL unless write-backs cost time
+    struct FramePage *frame_pages;        // Page every frame holds, NULL without reference streams
+    struct Tlb **tlbs;                    // One per core, NULL without reference streams
+    long long reference_count;            // Pages referenced by the streams
+    long long tlb_hit_count;              // References the TLB of their core translated
+    int last_decision_time;               // Time of the previous scheduling decision, -1 before the first
+    int metrics_fd;                       // Where the sampled time series goes, -1 for none
+    int metrics_binary;                   // 1 for the binary columnar form instead of CSV
+    int metrics_every;                    // Simulated time between samples
+    struct Metrics *metrics;              // Sampled time series, NULL if there is none
+    ContiguousMemory contiguousMemory;
+    Process *executed_proc_front; // Least recently executed process; processes are linked through their executed_prev/executed_next
+    Process *executed_proc_rear;  // Most recently executed process
+    int ready_process_count; // Over every core
+    struct Queue *waiting_processes; // Picked processes that did not fit in the memory
+    int finished;                    // 1 once the summary has been written
+    struct sched_result result;
+    Process **live_processes; // Every admitted process that has not finished, so snapshots can name them by position
+    int live_count;
+    int live_capacity;
+};
+
+struct sched_ctx
+{
+    struct Simulation sim;
+};
+
+struct sched_trace
+{
+    struct TraceRecord *records;
+    size_t count;
+};
+
+int tryAllocateMemory(struct Simulation *sim, Process *process);
+int tryFreeMemory(struct Simulation *sim, Process *process);
+
+void addToExecutedProcList(struct Simulation *sim, Process *process);
+void removeFromExecutedProcList(struct Simulation *sim, Process *process);
+Process *getEvictProcess(struct Simulation *sim, int node);
+
+int initialiseContiguousMemory(struct Simulation *sim);
+int alllocateContiguousMemory(struct Simulation *sim, int executed_proc_arr_size);
+void freeContiguousMemory(struct Simulation *sim, int start_address, int executed_proc_arr_size);
+
+int allocatePagedMemory(struct Simulation *sim, struct Process *process, int virtual_status);
+void freePagedMemory(struct Simulation *sim, Process *process);
+int allocateVirtualMemory(struct Simulation *sim, Process *pProcess);
+int pagesNeeded(struct Simulation *sim, int memory_size_kb);
+int sumPageLeft(struct Simulation *sim, int node);
+void evictPage(struct Simulation *sim, int num_frame, int virtual_status, int node);
+int vacateFrame(struct Simulation *sim, int frame);
+void releaseFrame(struct Simulation *sim, int frame);
+void evictFrames(struct Simulation *sim, int num_frame, Process *keep);
+void loadVirtualPages(struct Simulation *sim, Process *process);
+int fitAllPage(struct Simulation *sim, Process *process, int frame_needed);
+void printMemoryFrames(struct Simulation *sim, Process *process, int num_page);
+int getPagedMemoryUsage(struct Simulation *sim);
+
+void recordFinishedProcess(struct Simulation *sim, Process *process);
+void calculateAverageTurnover(struct Simulation *sim);
+void calculateMakeSpan(struct Simulation *sim, int time);
+void calculateOverhead(struct Simulation *sim);
+void printSummary(struct Simulation *sim);
+
+Process *admitProcess(struct Simulation *sim, struct TraceRecord *record);
+int quantaUntil(struct Simulation *sim, int time);
+int makeDecision(struct Simulation *sim);
+void sampleMetrics(struct Simulation *sim, int time);
+int stepSimulation(struct Simulation *sim);
+void finishSimulation(struct Simulation *sim);
+int schedule(struct Simulation *sim);
+void freeSimulationState(struct Simulation *sim);
+void cleanUp(struct Simulation *sim);
+
+// Function to create the queues and memory of a run with nothing in them.
+// The replacement policy is pointed at the frame map the simulation will
+// use, which differs from the one being filled while a snapshot is restored.
+void createSimulationState(struct Simulation *sim, const struct FrameMap *map)
+{
+    sim->cores = (struct Core *)malloc(sim->core_count * sizeof(struct Core));
+    if (sim->cores == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        // Each core draws its own lottery
+        sim->cores[i].current_process = NULL;
+        sim->cores[i].ready_processes = createReadyQueue(sim->scheduler_policy, sim->policy_seed + i);
+        sim->cores[i].busy_time = 0;
+        initStats(&sim->cores[i].turnaround_stats);
+        initStats(&sim->cores[i].overhead_stats);
+        initStats(&sim->cores[i].wait_stats);
+    }
+    sim->waiting_processes = createQueue();
+    sim->blocked_processes = createQueue();
+    sim->live_processes = NULL;
+    sim->live_count = sim->live_capacity = 0;
+    initialiseContiguousMemory(sim);
+    sim->page_table = createFramePools(sim->page_num, sim->node_count);
+    sim->dirty_frames = NULL;
+    if (sim->writeback_cost > 0)
+    {
+        sim->dirty_frames = (unsigned char *)calloc(sim->page_num, 1);
+        if (sim->dirty_frames == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    sim->frame_pages = NULL;
+    sim->tlbs = NULL;
+    if (sim->reference_pattern != -1)
+    {
+        sim->frame_pages = (struct FramePage *)malloc(sim->page_num * sizeof(struct FramePage));
+        sim->tlbs = (struct Tlb **)malloc(sim->core_count * sizeof(struct Tlb *));
+        if (sim->frame_pages == NULL || sim->tlbs == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(sim->frame_pages, -1, sim->page_num * sizeof(struct FramePage));
+        for (int i = 0; i < sim->core_count; i++)
+        {
+            sim->tlbs[i] = createTlb(sim->tlb_entries, sim->tlb_ways);
+        }
+    }
+    if (sim->replacement_policy != NULL)
+    {
+        createFrameMap(&sim->frame_map, sim->page_num);
+        sim->replacement_state = sim->replacement_policy->create(map, WORKING_SET_QUANTA * sim->quantum_time);
+    }
+}
+
+// Function to set up the state of a run before its trace is loaded.
+// Events are written to the file descriptor, or dropped if it is -1.
+void startSimulation(struct Simulation *sim, int fd)
+{
+    sim->trace = NULL;
+    sim->output = createOutputSink(fd);
+    sim->current_time = 0;
+    sim->process_count = 0;
+    sim->memory_usage = 0;
+    sim->total_process = 0;
+    sim->make_span = 0;
+    sim->total_turnover = 0;
+    sim->next_pid = 0;
+    sim->evicted_frame_count = 0;
+    sim->context_switch_count = 0;
+    sim->migration_count = 0;
+    sim->remote_time = 0;
+    sim->page_fault_count = 0;
+    sim->writeback_count = 0;
+    sim->switch_time = 0;
+    sim->reference_count = 0;
+    sim->tlb_hit_count = 0;
+    sim->last_decision_time = -1;
+    sim->metrics = sim->metrics_fd >= 0 ? createMetrics(sim->metrics_fd, sim->metrics_binary, sim->metrics_every) : NULL;
+    initStats(&sim->turnaround_stats);
+    initStats(&sim->overhead_stats);
+    initStats(&sim->wait_stats);
+    sim->executed_proc_front = sim->executed_proc_rear = NULL;
+    sim->ready_process_count = 0;
+    sim->finished = 0;
+    createSimulationState(sim, &sim->frame_map);
+}
+
+// Returns the NUMA node of a core; the cores are split into runs of
+// consecutive cores, one per node
+int coreNode(struct Simulation *sim, int core)
+{
+    return (int)((long long)core * sim->node_count / sim->core_count);
+}
+
+// Returns the node a process is bound to, or -1 if its frames may come
+// from any node
+int boundNode(struct Simulation *sim, Process *process)
+{
+    return sim->numa_policy == NUMA_BIND ? process->node : -1;
+}
+
+// Returns the number of frames a process holds on the node
+int framesOnNode(struct Simulation *sim, Process *process, int node)
+{
+    int first = sim->page_table->nodes[node].first_frame;
+    int end = first + framePoolSize(sim->page_table, node);
+    int count = 0;
+    for (int i = 0; i < process->frames.count; i++)
+    {
+        struct FrameRun *run = &process->frames.runs[i];
+        if (run->start == -1)
+            continue;
+        int low = run->start > first ? run->start : first;
+        int high = run->start + run->length < end ? run->start + run->length : end;
+        if (high > low)
+            count += high - low;
+    }
+    return count;
+}
+
+// Function to take free frames for the given slot of a process, on the
+// node the NUMA policy places it. Returns the number of frames taken,
+// which are consecutive and start at *start.
+int takeFrames(struct Simulation *sim, Process *process, int slot, int max_frames, int *start)
+{
+    return framePoolTakeFor(sim->page_table, sim->numa_policy, process->node, slot, max_frames, start);
+}
+
+// Check whether a process can get the frames it needs now. It cannot when
+// they are short and the frames of every process holding some it could
+// have are pinned.
+int framesAvailable(struct Simulation *sim, Process *pProcess, int frame_needed)
+{
+    int node = boundNode(sim, pProcess);
+    if (frame_needed <= sumPageLeft(sim, node))
+        return 1;
+    int pinned_holders = 0;
+    for (Process *process = sim->executed_proc_front; process != NULL; process = process->executed_next)
+    {
+        if (process->total_page <= 0 || (node != -1 && framesOnNode(sim, process, node) == 0))
+            continue;
+        if (!framesPinned(process))
+            return 1;
+        pinned_holders++;
+    }
+    return pinned_holders == 0;
+}
+
+// Allocation is not needed
+int allocateInfinite(struct Simulation *sim, Process *process)
+{
+    return 1;
+}
+
+int allocateFirstFit(struct Simulation *sim, Process *process)
+{
+    int start_address = alllocateContiguousMemory(sim, process->memory_executed_proc_arr_size);
+    if (start_address != -1)
+    {
+        process->memory_start_address = start_address;
+        return 1;
+    }
+    return 0;
+}
+
+int allocatePaged(struct Simulation *sim, Process *process)
+{
+    if (process->total_page == 0)
+    {
+        // If no pages have been allocated yet
+        if (!framesAvailable(sim, process, pagesNeeded(sim, process->memory_executed_proc_arr_size)))
+            return 0;
+        allocatePagedMemory(sim, process, NOT_VIRTUAL);
+    }
+    return 1;
+}
+
+int allocateVirtual(struct Simulation *sim, Process *process)
+{
+    if (sim->replacement_policy != NULL)
+    {
+        loadVirtualPages(sim, process);
+        return 1;
+    }
+    if (process->total_page == 0)
+    {
+        // If no pages have been allocated yet
+        int total_frame = pagesNeeded(sim, process->memory_executed_proc_arr_size);
+        if (!framesAvailable(sim, process, total_frame < MIN_RESIDENT_PAGES ? total_frame : MIN_RESIDENT_PAGES))
+            return 0;
+        allocateVirtualMemory(sim, process);
+    }
+    return 1;
+}
+
+// Record where the process was placed. Returns 0 if it was not placed.
+int placeContiguous(struct Simulation *sim, Process *process, int start_address, int reserved_size)
+{
+    if (start_address == -1)
+        return 0;
+    process->memory_start_address = start_address;
+    sim->memory_usage += reserved_size; // Add to the total memory used count
+    return 1;
+}
+
+int allocateBestFit(struct Simulation *sim, Process *process)
+{
+    int size = process->memory_executed_proc_arr_size;
+    return placeContiguous(sim, process, extentBestFit(sim->contiguousMemory.free_extents, size), size);
+}
+
+int allocateNextFit(struct Simulation *sim, Process *process)
+{
+    int size = process->memory_executed_proc_arr_size;
+    return placeContiguous(sim, process, extentNextFit(sim->contiguousMemory.free_extents, &sim->contiguousMemory.next_fit_cursor, size), size);
+}
+
+struct BuddyAllocator *buddyMemory(struct Simulation *sim)
+{
+    if (sim->contiguousMemory.buddy == NULL)
+        sim->contiguousMemory.buddy = createBuddyAllocator(sim->memory_size);
+    return sim->contiguousMemory.buddy;
+}
+
+// The whole power-of-two block counts as used, so the internal
+// fragmentation shows up in mem-usage
+int allocateBuddy(struct Simulation *sim, Process *process)
+{
+    int size = process->memory_executed_proc_arr_size;
+    return placeContiguous(sim, process, buddyAllocate(buddyMemory(sim), size), buddyBlockSize(buddyMemory(sim), size));
+}
+
+// A hole at least as large as the request exists
+int fitsExtents(struct Simulation *sim, int size)
+{
+    return size <= extentLargest(sim->contiguousMemory.free_extents);
+}
+
+int fitsEmptyExtents(struct Simulation *sim, int size)
+{
+    return size <= sim->memory_size;
+}
+
+int fitsBuddy(struct Simulation *sim, int size)
+{
+    return buddyBlockSize(buddyMemory(sim), size) <= buddyLargest(buddyMemory(sim));
+}
+
+// An empty buddy memory starts with the largest power of two that fits in it
+int fitsEmptyBuddy(struct Simulation *sim, int size)
+{
+    return buddyBlockSize(buddyMemory(sim), size) <= sim->memory_size;
+}
+
+void freeInfinite(struct Simulation *sim, Process *process)
+{
+}
+
+void freeFirstFit(struct Simulation *sim, Process *process)
+{
+    freeContiguousMemory(sim, process->memory_start_address, process->memory_executed_proc_arr_size);
+}
+
+void freeBuddy(struct Simulation *sim, Process *process)
+{
+    buddyFree(buddyMemory(sim), process->memory_start_address, process->memory_executed_proc_arr_size);
+    sim->memory_usage -= buddyBlockSize(buddyMemory(sim), process->memory_executed_proc_arr_size);
+}
+
+void printInfiniteUsage(struct Simulation *sim, Process *process)
+{
+}
+
+void printFirstFitUsage(struct Simulation *sim, Process *process)
+{
+    int memory_usage_perc = ceil(100 * (double)sim->memory_usage / sim->memory_size);
+
+    outputString(sim->output, ",mem-usage=");
+    outputInt(sim->output, memory_usage_perc);
+    outputString(sim->output, "%,allocated-at=");
+    outputInt(sim->output, process->memory_start_address);
+}
+
+// Print the share of the free memory that lies outside the largest hole,
+// i.e. that a process as large as all the free memory could not use
+void printFragmentation(struct Simulation *sim, int free_total, int largest)
+{
+    int fragmentation_perc = free_total == 0 ? 0 : ceil(100 * (double)(free_total - largest) / free_total);
+
+    outputString(sim->output, ",frag=");
+    outputInt(sim->output, fragmentation_perc);
+    outputChar(sim->output, '%');
+}
+
+void printExtentUsage(struct Simulation *sim, Process *process)
+{
+    printFirstFitUsage(sim, process);
+    printFragmentation(sim, extentFreeTotal(sim->contiguousMemory.free_extents), extentLargest(sim->contiguousMemory.free_extents));
+}
+
+void printBuddyUsage(struct Simulation *sim, Process *process)
+{
+    printFirstFitUsage(sim, process);
+    printFragmentation(sim, buddyMemory(sim)->free_total, buddyLargest(buddyMemory(sim)));
+}
+
+void printPagedUsage(struct Simulation *sim, Process *process)
+{
+    int memory_usage_perc = getPagedMemoryUsage(sim);
+
+    outputString(sim->output, ",mem-usage=");
+    outputInt(sim->output, memory_usage_perc);
+    outputChar(sim->output, '%');
+    if (sim->node_count > 1)
+    {
+        // Followed by the usage of every node
+        outputString(sim->output, ",node-usage=[");
+        for (int node = 0; node < sim->node_count; node++)
+        {
+            int size = framePoolSize(sim->page_table, node);
+            if (node > 0)
+                outputChar(sim->output, ',');
+            outputInt(sim->output, (int)ceil(100 * (double)(size - sumPageLeft(sim, node)) / size));
+            outputChar(sim->output, '%');
+        }
+        outputChar(sim->output, ']');
+    }
+    outputString(sim->output, ",mem-frames=[");
+    printMemoryFrames(sim, process, process->total_page);
+    outputChar(sim->output, ']');
+}
+
+// The range each process holds lies outside every hole, and the held
+// ranges and the holes add up to the memory, so no two of them overlap
+int extentHoldersValid(struct Simulation *sim)
+{
+    struct ExtentTree *tree = sim->contiguousMemory.free_extents;
+    long long held = 0;
+    for (int i = 0; i < sim->live_count; i++)
+    {
+        Process *process = sim->live_processes[i];
+        int size = process->memory_executed_proc_arr_size;
+        if (process->memory_start_address == -1)
+            continue;
+        if (size < 0 || size > sim->memory_size - process->memory_start_address ||
+            extentOverlaps(tree, process->memory_start_address, size))
+            return 0;
+        held += size;
+    }
+    return held == sim->memory_usage && held + extentFreeTotal(tree) == sim->memory_size;
+}
+
+// The block each process holds is whole and not free, and the held blocks
+// and the free ones add up to the memory the blocks cover
+int buddyHoldersValid(struct Simulation *sim)
+{
+    struct BuddyAllocator *buddy = buddyMemory(sim);
+    long long held = 0;
+    for (int i = 0; i < sim->live_count; i++)
+    {
+        Process *process = sim->live_processes[i];
+        int size = process->memory_executed_proc_arr_size;
+        if (process->memory_start_address == -1)
+            continue;
+        if (size < 0 || size > sim->memory_size || !buddyBlockHeld(buddy, process->memory_start_address, size))
+            return 0;
+        held += buddyBlockSize(buddy, size);
+    }
+    return held == sim->memory_usage && held + buddy->free_total == buddyCovered(buddy);
+}
+
+// Every frame a process holds is allocated in its node and held by no
+// other process
+int frameHoldersValid(struct Simulation *sim)
+{
+    char *held = (char *)calloc(sim->page_num > 0 ? sim->page_num : 1, 1);
+    if (held == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    int valid = 1;
+    for (int i = 0; i < sim->live_count && valid; i++)
+    {
+        Process *process = sim->live_processes[i];
+        for (int j = 0; j < process->frames.count && valid; j++)
+        {
+            struct FrameRun *run = &process->frames.runs[j];
+            for (int frame = run->start; run->start != -1 && frame < run->start + run->length; frame++)
+            {
+                if (held[frame] || !framePoolIsUsed(sim->page_table, frame))
+                    valid = 0;
+                held[frame] = 1;
+            }
+        }
+    }
+    free(held);
+    return valid;
+}
+
+const struct MemoryStrategy memory_strategies[] = {
+    {"infinite", allocateInfinite, freeInfinite, printInfiniteUsage, NULL, NULL, NULL, 0, 0},
+    {"first-fit", allocateFirstFit, freeFirstFit, printFirstFitUsage, fitsExtents, fitsEmptyExtents, extentHoldersValid, 0, 0},
+    {"best-fit", allocateBestFit, freeFirstFit, printExtentUsage, fitsExtents, fitsEmptyExtents, extentHoldersValid, 0, 0},
+    {"next-fit", allocateNextFit, freeFirstFit, printExtentUsage, fitsExtents, fitsEmptyExtents, extentHoldersValid, 0, 0},
+    {"buddy", allocateBuddy, freeBuddy, printBuddyUsage, fitsBuddy, fitsEmptyBuddy, buddyHoldersValid, 0, 0},
+    {"paged", allocatePaged, freePagedMemory, printPagedUsage, NULL, NULL, frameHoldersValid, 1, 0},
+    {"virtual", allocateVirtual, freePagedMemory, printPagedUsage, NULL, NULL, frameHoldersValid, 1, 1},
+};
+
+// Function to look up a memory strategy by name. Returns NULL if there is none.
+const struct MemoryStrategy *findMemoryStrategy(const char *name)
+{
+    for (size_t i = 0; i < sizeof(memory_strategies) / sizeof(memory_strategies[0]); i++)
+    {
+        if (strcmp(memory_strategies[i].name, name) == 0)
+            return &memory_strategies[i];
+    }
+    return NULL;
+}
+
+int tryAllocateMemory(struct Simulation *sim, Process *process)
+{
+    // Memory has already been allocated for the process
+    if (process->memory_start_address != -1)
+        return 1;
+
+    // Memory is only freed when a process finishes, so a process larger
+    // than every hole stays blocked without searching the memory again
+    if (sim->memory_strategy->fits != NULL && !sim->memory_strategy->fits(sim, process->memory_executed_proc_arr_size))
+        return 0;
+
+    return sim->memory_strategy->allocate(sim, process);
+}
+
+int tryFreeMemory(struct Simulation *sim, Process *process)
+{
+    sim->memory_strategy->release(sim, process);
+    return 0;
+}
+
+// Unlink the process from the order in which processes were executed
+void removeFromExecutedProcList(struct Simulation *sim, Process *process)
+{
+    if (!process->in_executed_list)
+        return;
+    if (process->executed_prev != NULL)
+        process->executed_prev->executed_next = process->executed_next;
+    else
+        sim->executed_proc_front = process->executed_next;
+    if (process->executed_next != NULL)
+        process->executed_next->executed_prev = process->executed_prev;
+    else
+        sim->executed_proc_rear = process->executed_prev;
+    process->executed_prev = process->executed_next = NULL;
+    process->in_executed_list = 0;
+}
+
+// Add or move the executed process to the end of the executed order
+void addToExecutedProcList(struct Simulation *sim, Process *process)
+{
+    removeFromExecutedProcList(sim, process);
+    process->executed_prev = sim->executed_proc_rear;
+    process->executed_next = NULL;
+    if (sim->executed_proc_rear != NULL)
+        sim->executed_proc_rear->executed_next = process;
+    else
+        sim->executed_proc_front = process;
+    sim->executed_proc_rear = process;
+    process->in_executed_list = 1;
+}
+
+// Select the least recently executed process that still holds pages and
+// whose frames are not pinned, with frames on the node unless it is -1
+Process *getEvictProcess(struct Simulation *sim, int node)
+{
+    // Processes without pages cannot be evicted,
+    // so drop them from the front as they are met
+    while (sim->executed_proc_front != NULL && sim->executed_proc_front->total_page <= 0)
+    {
+        removeFromExecutedProcList(sim, sim->executed_proc_front);
+    }
+    Process *process = sim->executed_proc_front;
+    while (process != NULL && (framesPinned(process) || process->total_page <= 0 ||
+                               (node != -1 && framesOnNode(sim, process, node) == 0)))
+        process = process->executed_next;
+    return process; // NULL if no process is left
+}
+
+int initialiseContiguousMemory(struct Simulation *sim)
+{
+    sim->contiguousMemory.free_extents = createExtentTree(sim->memory_size); // Initialise the memory to be a single hole
+    sim->contiguousMemory.next_fit_cursor = 0;
+    sim->contiguousMemory.buddy = NULL;
+
+    return 0;
+}
+
+int alllocateContiguousMemory(struct Simulation *sim, int executed_proc_arr_size)
+{
+    // Take the lowest-addressed hole that is large enough
+    int start_address = extentFirstFit(sim->contiguousMemory.free_extents, executed_proc_arr_size);
+
+    if (start_address != -1)
+    {
+        sim->memory_usage += executed_proc_arr_size; // Add to the total memory used count
+    }
+
+    return start_address; // Returns -1 if the allocation fails; returns the start address if the allocation is successful
+}
+
+void freeContiguousMemory(struct Simulation *sim, int start_address, int executed_proc_arr_size)
+{
+    extentFree(sim->contiguousMemory.free_extents, start_address, executed_proc_arr_size); // Coalesces with neighbouring holes
+
+    sim->memory_usage -= executed_proc_arr_size; // Reduce from the total memory used count
+}
+
+// Returns the number of pages needed to hold the given amount of memory
+int pagesNeeded(struct Simulation *sim, int memory_size_kb)
+{
+    return (memory_size_kb + sim->page_size - 1) / sim->page_size;
+}
+
+int allocatePagedMemory(struct Simulation *sim, struct Process *process, int virtual_status)
+{
+    int total_frame = pagesNeeded(sim, process->memory_executed_proc_arr_size);
+
+    int node = boundNode(sim, process);
+    int page_left = sumPageLeft(sim, node);
+    if (virtual_status == NOT_VIRTUAL)
+    {
+        process->total_page = total_frame;
+        if (page_left < total_frame && virtual_status == NOT_VIRTUAL)
+        {
+            evictPage(sim, total_frame, virtual_status, node);
+        }
+        fitAllPage(sim, process, total_frame);
+    }
+
+    if (virtual_status == IS_VIRTUAL)
+    {
+        int frame_needed = total_frame - process->total_page;
+        if (page_left + process->total_page < 4)
+        {
+            if (frame_needed > 4)
+            {
+                frame_needed = 4;
+            }
+
+            int evict_frames = frame_needed - page_left - process->total_page;
+            evictPage(sim, evict_frames, IS_VIRTUAL, node);
+        }
+        int counter = 0;
+        while (counter < frame_needed && sumPageLeft(sim, node) > 0)
+        {
+            int start;
+            int taken = takeFrames(sim, process, counter, frame_needed - counter, &start);
+            frameListWrite(&process->frames, counter, start, taken);
+            process->total_page += taken;
+            counter += taken;
+            if (sim->frame_pages == NULL) // Streams fault their pages in as they reference them
+                sim->page_fault_count += taken;
+        }
+    }
+
+    return 0;
+}
+
+void freePagedMemory(struct Simulation *sim, Process *process)
+{
+    outputInt(sim->output, sim->current_time);
+    outputString(sim->output, ",EVICTED,evicted-frames=[");
+    struct FramePrinter printer;
+    startFrames(&printer, sim->output, sim->frames_as_ranges);
+
+    int start, length;
+    while ((length = frameListTakeRun(&process->frames, INT_MAX, process->total_page, &start)) > 0)
+    {
+        outputFrameRun(&printer, start, length);
+        for (int frame = start; frame < start + length; frame++)
+        {
+            releaseFrame(sim, frame); // Mark the page as free
+        }
+    }
+    process->total_page = 0; // Reset the total_page count for the process
+    finishFrames(&printer);
+    outputString(sim->output, "]\n");
+}
+
+int allocateVirtualMemory(struct Simulation *sim, Process *pProcess)
+{
+    int total_frame = pagesNeeded(sim, pProcess->memory_executed_proc_arr_size);
+
+    int page_left = sumPageLeft(sim, boundNode(sim, pProcess));
+    if (total_frame > page_left)
+    {
+        allocatePagedMemory(sim, pProcess, IS_VIRTUAL);
+        return 0;
+    }
+    if (total_frame >= 4 && total_frame <= page_left)
+    {
+        allocatePagedMemory(sim, pProcess, IS_VIRTUAL);
+    }
+    return 0;
+}
+
+// Returns the number of free frames on the node, or on every node if it is -1
+int sumPageLeft(struct Simulation *sim, int node)
+{
+    return framePoolFree(sim->page_table, node);
+}
+
+// Function to evict the least recently executed processes until num_frame
+// frames could be free, counting only those of the node unless it is -1
+void evictPage(struct Simulation *sim, int num_frame, int virtual_status, int node)
+{
+    outputInt(sim->output, sim->current_time);
+    outputString(sim->output, ",EVICTED,evicted-frames=[");
+    struct FramePrinter printer;
+    startFrames(&printer, sim->output, sim->frames_as_ranges);
+    int initial_free_pages = sumPageLeft(sim, node);
+
+    int num_evict = 0;
+    while (initial_free_pages < num_frame)
+    {
+        struct Process *top_process = getEvictProcess(sim, node);
+
+        if (top_process == NULL)
+        {
+            break;
+        }
+
+        if (top_process->status == FINISHED)
+        {
+            continue;
+        }
+
+        if (virtual_status == IS_VIRTUAL)
+        {
+            num_evict = num_frame;
+        }
+        if (virtual_status == NOT_VIRTUAL)
+        {
+            num_evict = top_process->total_page;
+        }
+        int evicted_frames = 0;
+
+        // Take frames back from the first slots of the process
+        int start, length;
+        while ((length = frameListTakeRun(&top_process->frames, num_evict - evicted_frames, INT_MAX, &start)) > 0)
+        {
+            outputFrameRun(&printer, start, length);
+            for (int frame = start; frame < start + length; frame++)
+            {
+                sim->writeback_count += vacateFrame(sim, frame);
+                framePoolRelease(sim->page_table, frame); // Mark the page as free
+            }
+            evicted_frames += length;
+            sim->evicted_frame_count += length;
+        }
+        initial_free_pages = num_frame + initial_free_pages;
+        if (virtual_status == IS_VIRTUAL)
+        {
+            int left_frame = top_process->total_page - num_frame;
+            if (left_frame <= 0)
+            {
+                top_process->total_page = 0;
+            }
+        }
+        if (virtual_status == NOT_VIRTUAL)
+        {
+            top_process->total_page = 0;
+        }
+    }
+
+    finishFrames(&printer);
+    outputString(sim->output, "]\n");
+}
+
+// Function to forget what a frame holds and that it has been written.
+// Returns 1 if it had, so taking it away means writing it back first.
+int vacateFrame(struct Simulation *sim, int frame)
+{
+    if (sim->frame_pages != NULL)
+        sim->frame_pages[frame].pid = -1;
+    if (sim->dirty_frames == NULL || !sim->dirty_frames[frame])
+        return 0;
+    sim->dirty_frames[frame] = 0;
+    return 1;
+}
+
+// Function to free a frame whose process has finished with it, which
+// needs no write-back
+void releaseFrame(struct Simulation *sim, int frame)
+{
+    vacateFrame(sim, frame);
+    if (sim->replacement_policy != NULL && sim->frame_map.owner[frame] != NULL)
+    {
+        sim->replacement_policy->release(sim->replacement_state, frame);
+        sim->frame_map.owner[frame] = NULL;
+    }
+    framePoolRelease(sim->page_table, frame);
+}
+
+// Function to evict frames chosen by the replacement policy until
+// num_frame frames have gone, along with any frame the policy considers
+// expired. Frames of the given process are kept.
+void evictFrames(struct Simulation *sim, int num_frame, Process *keep)
+{
+    struct FramePrinter printer;
+    int evicted = 0;
+    while (1)
+    {
+        int frame = -1;
+        if (sim->replacement_policy->expired != NULL)
+            frame = sim->replacement_policy->expired(sim->replacement_state, sim->current_time, keep);
+        if (frame == -1 && evicted < num_frame)
+            frame = sim->replacement_policy->victim(sim->replacement_state, keep);
+        if (frame == -1)
+            break;
+
+        if (evicted++ == 0)
+        {
+            outputInt(sim->output, sim->current_time);
+            outputString(sim->output, ",EVICTED,evicted-frames=[");
+            startFrames(&printer, sim->output, sim->frames_as_ranges);
+        }
+        outputFrameRun(&printer, frame, 1);
+
+        Process *owner = sim->frame_map.owner[frame];
+        sim->replacement_policy->evict(sim->replacement_state, frame);
+        frameListWrite(&owner->frames, sim->frame_map.page[frame], -1, 1); // The slot stays, empty
+        sim->frame_map.owner[frame] = NULL;
+        sim->writeback_count += vacateFrame(sim, frame);
+        framePoolRelease(sim->page_table, frame);
+    }
+    if (evicted > 0)
+    {
+        finishFrames(&printer);
+        outputString(sim->output, "]\n");
+        sim->evicted_frame_count += evicted;
+    }
+}
+
+// Function to bring in the missing pages of a process that is about to
+// run under a replacement policy. Frames are evicted only as far as needed
+// for the process to have MIN_RESIDENT_PAGES resident (or all of its pages
+// if it has fewer); beyond that it takes whatever frames are free. Every
+// resident page then counts as referenced.
+void loadVirtualPages(struct Simulation *sim, Process *process)
+{
+    int total_frame = pagesNeeded(sim, process->memory_executed_proc_arr_size);
+    process->total_page = total_frame;
+
+    // A process bound to a node only makes room there
+    int node = boundNode(sim, process);
+    int missing = total_frame - process->frames.frame_count;
+    if (missing > sumPageLeft(sim, node))
+    {
+        int minimum = total_frame < MIN_RESIDENT_PAGES ? total_frame : MIN_RESIDENT_PAGES;
+        if (node != -1)
+        {
+            sim->frame_map.evictable_first = sim->page_table->nodes[node].first_frame;
+            sim->frame_map.evictable_end = sim->frame_map.evictable_first + framePoolSize(sim->page_table, node);
+        }
+        evictFrames(sim, minimum - process->frames.frame_count - sumPageLeft(sim, node), process);
+        sim->frame_map.evictable_first = 0;
+        sim->frame_map.evictable_end = sim->frame_map.count;
+    }
+
+    int slot, length;
+    while (sumPageLeft(sim, node) > 0 && (slot = frameListFirstEmpty(&process->frames, total_frame, &length)) != -1)
+    {
+        int start;
+        int taken = takeFrames(sim, process, slot, length, &start);
+        frameListWrite(&process->frames, slot, start, taken);
+        if (sim->frame_pages == NULL) // Streams fault their pages in as they reference them
+            sim->page_fault_count += taken;
+        for (int i = 0; i < taken; i++)
+        {
+            sim->frame_map.owner[start + i] = process;
+            sim->frame_map.page[start + i] = slot + i;
+            sim->replacement_policy->load(sim->replacement_state, start + i);
+        }
+    }
+
+    for (int i = 0; i < process->frames.count; i++)
+    {
+        struct FrameRun *run = &process->frames.runs[i];
+        for (int frame = run->start; run->start != -1 && frame < run->start + run->length; frame++)
+        {
+            sim->replacement_policy->reference(sim->replacement_state, frame, sim->current_time);
+        }
+    }
+}
+
+int fitAllPage(struct Simulation *sim, Process *process, int frame_needed)
+{
+    int count = 0;
+    while (count < frame_needed && sumPageLeft(sim, boundNode(sim, process)) > 0)
+    {
+        int start;
+        int taken = takeFrames(sim, process, count, frame_needed - count, &start);
+        frameListWrite(&process->frames, count, start, taken);
+        count += taken;
+    }
+    return 0;
+}
+
+void printMemoryFrames(struct Simulation *sim, Process *process, int num_page)
+{
+    struct FramePrinter printer;
+    startFrames(&printer, sim->output, sim->frames_as_ranges);
+    int slot = 0;
+    for (int i = 0; i < process->frames.count && slot < num_page; i++)
+    {
+        struct FrameRun *run = &process->frames.runs[i];
+        int length = run->length < num_page - slot ? run->length : num_page - slot;
+        if (run->start == -1)
+        {
+            slot += length;
+            continue;
+        }
+        if (sim->frames_as_ranges)
+        {
+            outputFrameRun(&printer, run->start, length);
+            slot += length;
+            continue;
+        }
+        for (int j = 0; j < length; j++, slot++)
+        {
+            outputInt(sim->output, run->start + j);
+            if (slot < num_page - 1)
+                outputChar(sim->output, ','); // Print with a comma for all but the last slot
+        }
+    }
+    finishFrames(&printer);
+}
+
+int getPagedMemoryUsage(struct Simulation *sim)
+{
+    int allocated = sim->page_table->frame_count - sim->page_table->free_count;
+    int memory_usage_perc = ceil(100 * (double)allocated / sim->page_num);
+    return memory_usage_perc;
+}
+
+// Function to add the turnaround, overhead and waiting time of a process
+// that has just finished to the statistics of the core it last ran on
+void recordFinishedProcess(struct Simulation *sim, Process *process)
+{
+    struct Core *core = &sim->cores[process->core != -1 ? process->core : 0];
+    int turnaround_time = sim->current_time - process->arrival_time;
+    int service_time = process->sum_remaining_time;
+    addStat(&core->turnaround_stats, turnaround_time);
+    addStat(&core->wait_stats, turnaround_time - service_time);
+
+    double overhead = (double)turnaround_time / service_time;
+    if (overhead > 0) // A process that took no time has no overhead to speak of
+        addStat(&core->overhead_stats, overhead);
+}
+
+// Function to merge the statistics of every core into those of the run
+void mergeCoreStats(struct Simulation *sim)
+{
+    initStats(&sim->turnaround_stats);
+    initStats(&sim->overhead_stats);
+    initStats(&sim->wait_stats);
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        mergeStats(&sim->turnaround_stats, &sim->cores[i].turnaround_stats);
+        mergeStats(&sim->overhead_stats, &sim->cores[i].overhead_stats);
+        mergeStats(&sim->wait_stats, &sim->cores[i].wait_stats);
+    }
+}
+
+void calculateAverageTurnover(struct Simulation *sim)
+{
+    sim->result.average_turnover = ceil(sim->turnaround_stats.sum / sim->total_process);
+}
+
+void calculateMakeSpan(struct Simulation *sim, int time)
+{
+    sim->make_span = sim->make_span + time;
+}
+
+void calculateOverhead(struct Simulation *sim)
+{
+    struct RunningStats *overhead = &sim->overhead_stats;
+    sim->result.max_overhead = overhead->count > 0 ? overhead->max : 0.0;
+    sim->result.average_overhead = overhead->count > 0 ? overhead->sum / overhead->count : 0.0;
+}
+
+void calculateDistributions(struct Simulation *sim)
+{
+    describeStats(&sim->turnaround_stats, &sim->result.turnaround);
+    describeStats(&sim->overhead_stats, &sim->result.overhead);
+    describeStats(&sim->wait_stats, &sim->result.wait);
+}
+
+// Function to print one measure as "<name> mean M sd S p50 ... p99.9 ..."
+void printDistribution(struct Simulation *sim, const char *name, struct sched_distribution *distribution)
+{
+    outputChar(sim->output, '\n');
+    outputString(sim->output, name);
+    outputString(sim->output, " mean ");
+    outputFixed(sim->output, distribution->mean, 2);
+    outputString(sim->output, " sd ");
+    outputFixed(sim->output, distribution->stddev, 2);
+    outputString(sim->output, " p50 ");
+    outputFixed(sim->output, distribution->p50, 2);
+    outputString(sim->output, " p95 ");
+    outputFixed(sim->output, distribution->p95, 2);
+    outputString(sim->output, " p99 ");
+    outputFixed(sim->output, distribution->p99, 2);
+    outputString(sim->output, " p99.9 ");
+    outputFixed(sim->output, distribution->p999, 2);
+}
+
+// Returns the share of the makespan a core spent running processes
+double coreUtilisation(struct Simulation *sim, int core)
+{
+    return sim->result.makespan > 0 ? (double)sim->cores[core].busy_time / sim->result.makespan : 0.0;
+}
+
+// Function to print the summary lines after the events
+void printSummary(struct Simulation *sim)
+{
+    struct sched_result *result = &sim->result;
+
+    outputString(sim->output, "Turnaround time ");
+    outputFixed(sim->output, result->average_turnover, 0);
+    outputChar(sim->output, '\n');
+
+    // Print the maximum and average overhead values
+    outputString(sim->output, "Time overhead ");
+    outputFixed(sim->output, result->max_overhead, 2);
+    outputChar(sim->output, ' ');
+    outputFixed(sim->output, result->average_overhead, 2);
+    outputChar(sim->output, '\n');
+
+    if (sim->report_evictions)
+    {
+        outputString(sim->output, "Evictions ");
+        outputInt(sim->output, result->evictions);
+        outputChar(sim->output, '\n');
+    }
+    outputString(sim->output, "Makespan ");
+    outputInt(sim->output, result->makespan);
+    if (sim->core_count > 1)
+    {
+        for (int i = 0; i < sim->core_count; i++)
+        {
+            outputString(sim->output, "\nCore ");
+            outputInt(sim->output, i);
+            outputString(sim->output, " utilisation ");
+            outputFixed(sim->output, 100 * coreUtilisation(sim, i), 2);
+            outputChar(sim->output, '%');
+        }
+        outputString(sim->output, "\nMigrations ");
+        outputInt(sim->output, result->migrations);
+    }
+    if (sim->node_count > 1)
+    {
+        outputString(sim->output, "\nRemote access time ");
+        outputInt(sim->output, result->remote_time);
+    }
+    if (sim->fault_cost > 0 || sim->writeback_cost > 0 || sim->reference_pattern != -1)
+    {
+        outputString(sim->output, "\nPage faults ");
+        outputInt(sim->output, result->page_faults);
+        outputString(sim->output, "\nWrite-backs ");
+        outputInt(sim->output, result->writebacks);
+    }
+    if (sim->reference_pattern != -1)
+    {
+        outputString(sim->output, "\nFault rate ");
+        outputFixed(sim->output, 100 * result->fault_rate, 2);
+        outputString(sim->output, "%\nTLB hit rate ");
+        outputFixed(sim->output, 100 * result->tlb_hit_rate, 2);
+        outputChar(sim->output, '%');
+    }
+    if (sim->switch_cost > 0)
+    {
+        outputString(sim->output, "\nContext switch time ");
+        outputInt(sim->output, result->switch_time);
+    }
+    if (sim->report_percentiles)
+    {
+        printDistribution(sim, "Turnaround", &result->turnaround);
+        printDistribution(sim, "Overhead", &result->overhead);
+        printDistribution(sim, "Wait", &result->wait);
+        for (int i = 0; sim->core_count > 1 && i < sim->core_count; i++)
+        {
+            char name[32];
+            struct sched_distribution turnaround;
+            snprintf(name, sizeof(name), "Core %d turnaround", i);
+            describeStats(&sim->cores[i].turnaround_stats, &turnaround);
+            printDistribution(sim, name, &turnaround);
+        }
+    }
+    outputFlush(sim->output);
+}
+
+// Function to add a process to the table of live processes
+void addLiveProcess(struct Simulation *sim, Process *process)
+{
+    if (sim->live_count == sim->live_capacity)
+    {
+        sim->live_capacity = sim->live_capacity ? sim->live_capacity * 2 : 16;
+        sim->live_processes = (Process **)realloc(sim->live_processes, sim->live_capacity * sizeof(Process *));
+        if (sim->live_processes == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    process->live_index = sim->live_count;
+    sim->live_processes[sim->live_count++] = process;
+}
+
+// Function to drop a process from the table, moving the last one into its place
+void removeLiveProcess(struct Simulation *sim, Process *process)
+{
+    Process *last = sim->live_processes[--sim->live_count];
+    last->live_index = process->live_index;
+    sim->live_processes[process->live_index] = last;
+}
+
+// Function to start the page-reference stream of a process: the list the
+// references file gives it, or the stream of the --references pattern if
+// the file does not name it. Returns NULL without reference streams.
+struct PageReferences *startReferences(struct Simulation *sim, Process *process)
+{
+    if (sim->reference_pattern == -1)
+        return NULL;
+    int pattern = sim->reference_pattern;
+    const struct ReferenceList *list = NULL;
+    if (sim->reference_table != NULL && (list = findReferenceList(sim->reference_table, process->name)) != NULL)
+        pattern = REF_FILE;
+    uint64_t seed = sim->policy_seed ^ (uint64_t)(process->pid + 1) * 0x9E3779B97F4A7C15ull; // Its own zipf draws
+    return createPageReferences(pattern, pagesNeeded(sim, process->memory_executed_proc_arr_size), list, seed,
+                                WORKING_SET_QUANTA * sim->quantum_time * sim->reference_rate);
+}
+
+// Enwraps the parameters of a trace line into a process instance
+Process *admitProcess(struct Simulation *sim, struct TraceRecord *record)
+{
+    struct Process *new_process = malloc(sizeof(struct Process));
+    if (new_process == NULL)
+    {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // Assign the scanned values to the process
+    new_process->pid = sim->next_pid++;
+    memcpy(new_process->name, record->name, sizeof(new_process->name));
+    new_process->arrival_time = record->arrival_time;
+    new_process->remaining_time = record->service_time;
+    new_process->memory_executed_proc_arr_size = record->memory_size;
+    new_process->status = READY;
+    new_process->memory_start_address = -1; // Initialse the start address to be -1 as memory is not allocated for the process yet
+    new_process->total_page = 0;
+    new_process->frames = (struct FrameList){NULL, 0, 0, 0}; // No frames until the first paged allocation
+    new_process->executed_prev = new_process->executed_next = NULL;
+    new_process->in_executed_list = 0;
+    new_process->sum_remaining_time = record->service_time;
+    new_process->level = 0;
+    new_process->boost_epoch = 0;
+    new_process->tickets = record->tickets > 0 ? record->tickets : DEFAULT_TICKETS;
+    new_process->pass = 0;
+    new_process->core = -1;
+    new_process->node = 0;
+    new_process->ready_at = -1;
+    new_process->refs = startReferences(sim, new_process);
+    addLiveProcess(sim, new_process);
+
+    sim->process_count += 1; // Increase the count of live processes by 1
+    sim->total_process += 1;
+    return new_process;
+}
+
+// Returns the number of quanta from the current time until the first
+// quantum boundary at or after the given time (at least one)
+int quantaUntil(struct Simulation *sim, int time)
+{
+    int quanta = (time - sim->current_time + sim->quantum_time - 1) / sim->quantum_time;
+    return quanta > 1 ? quanta : 1;
+}
+
+// Returns the number of processes a core has, running or ready
+int coreLoad(struct Core *core)
+{
+    return core->ready_processes->size + (core->current_process != NULL);
+}
+
+// Function to pick the core that takes a newly arrived process: the one
+// with the fewest processes, the lowest numbered on a tie
+struct Core *leastLoadedCore(struct Simulation *sim)
+{
+    struct Core *best = &sim->cores[0];
+    for (int i = 1; i < sim->core_count; i++)
+    {
+        if (coreLoad(&sim->cores[i]) < coreLoad(best))
+            best = &sim->cores[i];
+    }
+    return best;
+}
+
+// Function to move the process that the core with the most ready processes
+// would run next onto the ready queue of an idle core. Returns 0 if no
+// other core has a process to spare.
+int stealProcess(struct Simulation *sim, struct Core *thief)
+{
+    struct Core *victim = NULL;
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        struct Core *core = &sim->cores[i];
+        if (core != thief && core->ready_processes->size > 0 &&
+            (victim == NULL || core->ready_processes->size > victim->ready_processes->size))
+            victim = core;
+    }
+    if (victim == NULL)
+        return 0;
+    requeueReady(thief->ready_processes, dispatchReady(victim->ready_processes));
+    return 1;
+}
+
+// Returns the part of a quantum a process running on the core loses to
+// frames on other nodes: the remote cost, in proportion to the share of its
+// frames they hold, rounded up
+int remotePenalty(struct Simulation *sim, struct Core *core, Process *process)
+{
+    int resident = process->frames.frame_count;
+    if (sim->node_count == 1 || sim->remote_cost == 0 || resident == 0)
+        return 0;
+    int remote = resident - framesOnNode(sim, process, coreNode(sim, (int)(core - sim->cores)));
+    return (int)(((long long)sim->remote_cost * remote + resident - 1) / resident);
+}
+
+// Function to mark every resident page of a process that has run as
+// written, so evicting it costs a write-back
+void markDirty(struct Simulation *sim, Process *process)
+{
+    if (sim->dirty_frames == NULL)
+        return;
+    for (int i = 0; i < process->frames.count; i++)
+    {
+        struct FrameRun *run = &process->frames.runs[i];
+        if (run->start != -1)
+            memset(sim->dirty_frames + run->start, 1, run->length);
+    }
+}
+
+// Function to bring a page a running process referenced into one of its
+// own frames: an empty one if it has one, otherwise the one holding its
+// least recently referenced page, written back first if it is dirty. The
+// time the fault stalls the process is added to *stall. Returns the frame,
+// or -1 if the process holds none and the page stays out.
+int faultPage(struct Simulation *sim, Process *process, int page, int *stall)
+{
+    struct PageReferences *refs = process->refs;
+    int victim = -1;
+    for (int i = 0; i < process->frames.count; i++)
+    {
+        struct FrameRun *run = &process->frames.runs[i];
+        for (int frame = run->start; run->start != -1 && frame < run->start + run->length; frame++)
+        {
+            if (sim->frame_pages[frame].pid == -1)
+            {
+                victim = frame;
+                break;
+            }
+            if (victim == -1 ||
+                refs->last_use[sim->frame_pages[frame].page] < refs->last_use[sim->frame_pages[victim].page])
+                victim = frame;
+        }
+        if (victim != -1 && sim->frame_pages[victim].pid == -1)
+            break;
+    }
+    sim->page_fault_count++;
+    refs->faults++;
+    *stall += sim->fault_cost;
+    if (victim == -1)
+        return -1;
+    if (vacateFrame(sim, victim))
+    {
+        sim->writeback_count++;
+        *stall += sim->writeback_cost;
+    }
+    sim->frame_pages[victim].pid = process->pid;
+    sim->frame_pages[victim].page = page;
+    refs->frame_of_page[page] = victim;
+    return victim;
+}
+
+// Function to run the reference stream of a process for its quantum on a
+// core, less what it loses to remote frames. Each reference takes a tick,
+// 1/rate of a time unit, and is translated by the TLB of the core; a fault
+// stalls the process for its cost in ticks as well, and a stall that runs
+// past the end of the quantum is taken from the next. Returns the running
+// time the references made, which is the quantum unless they stalled.
+int runReferences(struct Simulation *sim, struct Core *core, Process *process, int penalty)
+{
+    struct PageReferences *refs = process->refs;
+    struct Tlb *tlb = sim->tlbs[core - sim->cores];
+    long long budget = (long long)(sim->quantum_time - penalty) * sim->reference_rate - refs->owed;
+    long long used = 0;
+    int made = 0;
+    while (used < budget)
+    {
+        int page = nextReference(refs);
+        int frame = refs->frame_of_page[page];
+        int stall = 0;
+        int faulted = frame == -1 || sim->frame_pages[frame].pid != process->pid || sim->frame_pages[frame].page != page;
+        if (faulted)
+            frame = faultPage(sim, process, page, &stall);
+        if (frame != -1)
+        {
+            // A translation the fault has just changed cannot hit
+            if (tlbLookup(tlb, process->pid, page, frame) && !faulted)
+            {
+                refs->tlb_hits++;
+                sim->tlb_hit_count++;
+            }
+            if (sim->dirty_frames != NULL)
+                sim->dirty_frames[frame] = 1;
+            if (sim->replacement_policy != NULL)
+                sim->replacement_policy->reference(sim->replacement_state, frame, sim->current_time);
+        }
+        used += 1 + (long long)stall * sim->reference_rate;
+        made++;
+    }
+    refs->owed = used - budget;
+    sim->reference_count += made;
+
+    refs->working_set_total += refs->distinct;
+    refs->working_set_samples++;
+    refs->credit += made % sim->reference_rate;
+    int progress = made / sim->reference_rate + refs->credit / sim->reference_rate;
+    refs->credit %= sim->reference_rate;
+    return progress;
+}
+
+// Function to append the fault rate, TLB hit rate and mean working set of
+// a process with a reference stream to its FINISHED line
+void printReferenceStats(struct Simulation *sim, struct PageReferences *refs)
+{
+    long long references = refs->position > 0 ? refs->position : 1;
+    outputString(sim->output, ",fault-rate=");
+    outputFixed(sim->output, 100.0 * refs->faults / references, 2);
+    outputString(sim->output, "%,tlb-hit-rate=");
+    outputFixed(sim->output, 100.0 * refs->tlb_hits / references, 2);
+    outputString(sim->output, "%,working-set=");
+    outputFixed(sim->output,
+                refs->working_set_samples > 0 ? (double)refs->working_set_total / refs->working_set_samples : 0.0, 0);
+}
+
+// Function to charge the process a core ran for its quantum, less what it
+// lost to remote frames or stalled on its page faults, and retire it if
+// it has completed
+void chargeCore(struct Simulation *sim, struct Core *core)
+{
+    Process *process = core->current_process;
+    if (process == NULL)
+        return;
+    int penalty = remotePenalty(sim, core, process);
+    if (process->refs != NULL)
+        process->remaining_time -= runReferences(sim, core, process, penalty);
+    else
+    {
+        markDirty(sim, process);
+        process->remaining_time -= sim->quantum_time - penalty;
+    }
+    sim->remote_time += penalty;
+    core->busy_time += sim->quantum_time;
+
+    // Execution of the process completed
+    if (process->remaining_time <= 0)
+    {
+        sim->process_count--; // Decrease the count of unfinished processes
+        recordFinishedProcess(sim, process);
+        tryFreeMemory(sim, process); // Free the memory
+
+        // Print finished process
+        outputInt(sim->output, sim->current_time);
+        outputString(sim->output, ",FINISHED,process-name=");
+        outputString(sim->output, process->name);
+        outputString(sim->output, ",proc-remaining=");
+        outputInt(sim->output, sim->ready_process_count);
+        if (process->refs != NULL)
+        {
+            printReferenceStats(sim, process->refs);
+            freePageReferences(process->refs);
+        }
+        outputChar(sim->output, '\n');
+
+        process->status = FINISHED;
+        finishReady(core->ready_processes, process);
+        removeFromExecutedProcList(sim, process);
+        removeLiveProcess(sim, process);
+        freeFrameList(&process->frames); // Free memory allocated for the process
+        free(process);                   // Free memory allocated for the process
+        core->current_process = NULL;
+    }
+}
+
+// Function to block a process instead of running it while the pages it
+// faulted on are brought in, after the dirty frames evicted to make room
+// for them are written back. Its frames are pinned until it has run with
+// them, so it cannot lose them to the next process that faults. Returns 0
+// if it has nothing to wait for.
+int blockOnPaging(struct Simulation *sim, Process *process, int faults, int writebacks)
+{
+    int wait = faults * sim->fault_cost + writebacks * sim->writeback_cost;
+    if (wait == 0)
+        return 0;
+    process->status = BLOCKED;
+    process->ready_at = sim->current_time + wait;
+    sim->ready_process_count--;
+    enqueue(sim->blocked_processes, process);
+    addToExecutedProcList(sim, process); // It holds pages others may wait on now
+
+    outputInt(sim->output, sim->current_time);
+    outputString(sim->output, ",BLOCKED,process-name=");
+    outputString(sim->output, process->name);
+    outputString(sim->output, ",page-faults=");
+    outputInt(sim->output, faults);
+    outputString(sim->output, ",write-backs=");
+    outputInt(sim->output, writebacks);
+    outputString(sim->output, ",ready-at=");
+    outputInt(sim->output, process->ready_at);
+    outputChar(sim->output, '\n');
+    return 1;
+}
+
+// Function to hand the blocked processes whose pages are in to the core
+// with the fewest processes, in the order they blocked
+void wakeProcesses(struct Simulation *sim)
+{
+    for (int i = sim->blocked_processes->size; i > 0; i--)
+    {
+        Process *process = dequeue(sim->blocked_processes);
+        if (process->ready_at > sim->current_time)
+        {
+            enqueue(sim->blocked_processes, process);
+            continue;
+        }
+        process->status = READY;
+        requeueReady(leastLoadedCore(sim)->ready_processes, process);
+        sim->ready_process_count++;
+    }
+}
+
+// Returns the earliest time a blocked process will be ready, INT_MAX if
+// none is blocked
+int nextWakeTime(struct Simulation *sim)
+{
+    struct Queue *blocked = sim->blocked_processes;
+    int time = INT_MAX;
+    for (int i = 0; i < blocked->size; i++)
+    {
+        Process *process = blocked->items[(blocked->front + i) % blocked->capacity];
+        if (process->ready_at < time)
+            time = process->ready_at;
+    }
+    return time;
+}
+
+// Function to give a core with ready processes its process for the next
+// quantum. The process it ran goes back to its ready queue first.
+void dispatchCore(struct Simulation *sim, struct Core *core)
+{
+    // If there are RUNNING processes,
+    // change the status of the running process to READY
+    // and hand it back to the policy
+    Process *previous_process = core->current_process;
+    if (core->current_process != NULL)
+    {
+        core->current_process->status = READY;
+        preemptReady(core->ready_processes, core->current_process);
+        sim->ready_process_count++;
+    }
+
+    // Try allocate memory to the processes the policy picks until one
+    // can run. Those that do not fit wait aside and go back once a
+    // process has been picked, so the policy does not offer them again
+    // straight away; those whose pages have to be brought in block and
+    // leave the core to the next.
+    Process *next_process = dispatchReady(core->ready_processes);
+    while (next_process != NULL)
+    {
+        int faults = sim->page_fault_count;
+        int writebacks = sim->writeback_count;
+        if (!tryAllocateMemory(sim, next_process))
+            enqueue(sim->waiting_processes, next_process);
+        else if (!blockOnPaging(sim, next_process, sim->page_fault_count - faults, sim->writeback_count - writebacks))
+            break;
+        next_process = dispatchReady(core->ready_processes);
+    }
+    while (!isEmpty(sim->waiting_processes))
+    {
+        requeueReady(core->ready_processes, dequeue(sim->waiting_processes));
+    }
+
+    // No ready process fits in the memory. Only processes too large
+    // for the whole memory could be in this state, and those are
+    // never admitted, but time still moves on rather than spinning.
+    core->current_process = next_process;
+    if (next_process == NULL)
+        return;
+
+    // A process that last ran on another core pays to move
+    int index = (int)(core - sim->cores);
+    next_process->ready_at = -1;
+    if (next_process->core != -1 && next_process->core != index)
+    {
+        next_process->remaining_time += sim->migration_cost;
+        sim->migration_count++;
+    }
+    next_process->core = index;
+
+    // Run the process and change its status to RUNNING
+    if (next_process != previous_process)
+        sim->context_switch_count++;
+    sim->ready_process_count--;
+    next_process->status = RUNNING;
+    addToExecutedProcList(sim, next_process);
+    if (next_process->remaining_time > 0)
+    {
+        // Print running process
+        outputInt(sim->output, sim->current_time);
+        outputString(sim->output, ",RUNNING,process-name=");
+        outputString(sim->output, next_process->name);
+        outputString(sim->output, ",remaining-time=");
+        outputInt(sim->output, next_process->remaining_time);
+        sim->memory_strategy->print_usage(sim, next_process);
+        if (sim->core_count > 1)
+        {
+            outputString(sim->output, ",core=");
+            outputInt(sim->output, index);
+        }
+        outputChar(sim->output, '\n');
+    }
+}
+
+// Function to pick the process for the next quantum on every core, in
+// core order
+void dispatchCores(struct Simulation *sim)
+{
+    // A core with nothing to run takes work from the busiest core;
+    // one still running its process and with nothing ready keeps it
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        struct Core *core = &sim->cores[i];
+        if (isReadyEmpty(core->ready_processes) && (core->current_process != NULL || !stealProcess(sim, core)))
+            continue;
+        dispatchCore(sim, core);
+    }
+}
+
+// Function to make one scheduling decision: admit the processes that have
+// arrived, charge the running processes for their quantum and pick the
+// process for the next quantum on every core, in core order. Returns 0
+// once every process has finished.
+int makeDecision(struct Simulation *sim)
+{
+    if (sim->finished)
+        return 0;
+    if (sim->process_count == 0 && !hasTraceRecord(sim->trace))
+    {
+        finishSimulation(sim);
+        return 0;
+    }
+
+    // Check for processes ready to run
+    while (hasTraceRecord(sim->trace) && nextTraceArrival(sim->trace) <= sim->current_time)
+    {
+        struct TraceRecord record = takeTraceRecord(sim->trace);
+        if (sim->memory_strategy->fits_empty != NULL && !sim->memory_strategy->fits_empty(sim, record.memory_size))
+        {
+            // It would wait for memory forever, so it is never admitted
+            if (sim->report_skipped)
+                fprintf(stderr, "Process %s needs %d KB, more than the memory can hold; skipped\n",
+                        record.name, record.memory_size);
+            continue;
+        }
+        struct Core *core = leastLoadedCore(sim);
+        Process *process = admitProcess(sim, &record);
+        process->node = coreNode(sim, (int)(core - sim->cores));
+        admitReady(core->ready_processes, process);
+        sim->ready_process_count++;
+    }
+    wakeProcesses(sim);
+
+    // Update remaining time of the running processes
+    int running = 0;
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        chargeCore(sim, &sim->cores[i]);
+        running += sim->cores[i].current_process != NULL;
+    }
+
+    // Check if there are any ready processes
+    if (sim->ready_process_count == 0)
+    {
+        // No process is ready
+        int wake = nextWakeTime(sim);
+        if (running == 0)
+        {
+            // If no process is running either, jump straight to the
+            // first quantum boundary at or after the next arrival or
+            // the first blocked process being ready
+            int until = hasTraceRecord(sim->trace) ? nextTraceArrival(sim->trace) : INT_MAX;
+            if (wake < until)
+                until = wake;
+            if (until == INT_MAX)
+                sim->current_time += sim->quantum_time;
+            else
+                sim->current_time += sim->quantum_time * quantaUntil(sim, until);
+            return 1;
+        }
+        // Running processes keep running instead of changing their
+        // status to ready. Nothing happens until one finishes, the
+        // next process arrives or a blocked one is ready, so skip the
+        // quanta in between
+        // Reference streams run quantum by quantum, since how far a
+        // process gets depends on its faults
+        int skip = sim->reference_pattern != -1 ? 1 : INT_MAX;
+        for (int i = 0; i < sim->core_count; i++)
+        {
+            Process *process = sim->cores[i].current_process;
+            if (process == NULL)
+                continue;
+            int progress = sim->quantum_time - remotePenalty(sim, &sim->cores[i], process);
+            if ((process->remaining_time + progress - 1) / progress < skip)
+                skip = (process->remaining_time + progress - 1) / progress;
+        }
+        if (hasTraceRecord(sim->trace))
+        {
+            int until_arrival = quantaUntil(sim, nextTraceArrival(sim->trace));
+            if (until_arrival < skip)
+                skip = until_arrival;
+        }
+        if (wake != INT_MAX && quantaUntil(sim, wake) < skip)
+            skip = quantaUntil(sim, wake);
+        if (skip > 1)
+        {
+            for (int i = 0; i < sim->core_count; i++)
+            {
+                struct Core *core = &sim->cores[i];
+                if (core->current_process == NULL)
+                    continue;
+                int penalty = remotePenalty(sim, core, core->current_process);
+                core->current_process->remaining_time -= (skip - 1) * (sim->quantum_time - penalty);
+                sim->remote_time += (skip - 1) * penalty;
+                core->busy_time += (skip - 1) * sim->quantum_time;
+            }
+            sim->current_time += (skip - 1) * sim->quantum_time;
+        }
+    }
+    else
+    {
+        int switches = sim->context_switch_count;
+        dispatchCores(sim);
+        if (sim->context_switch_count > switches)
+        {
+            // The cores change process side by side, so the decision
+            // pays for one switch however many of them changed
+            sim->current_time += sim->switch_cost;
+            sim->switch_time += sim->switch_cost;
+        }
+    }
+
+    sim->current_time += sim->quantum_time; // Update current time
+    return 1;
+}
+
+// Function to add a sample to the time series at the first decision at or
+// after every multiple of the sampling interval. The state is the one left
+// by the decision, which holds until the next.
+void sampleMetrics(struct Simulation *sim, int time)
+{
+    struct Metrics *metrics = sim->metrics;
+    if (sim->last_decision_time >= 0 && time / metrics->every == sim->last_decision_time / metrics->every)
+        return;
+    int frames_used = sim->page_table->frame_count - sim->page_table->free_count;
+    int values[METRICS_COLUMNS];
+    values[METRICS_TIME] = time;
+    values[METRICS_READY] = sim->ready_process_count;
+    values[METRICS_MEMORY_USAGE] = sim->memory_strategy->uses_frames
+                                       ? getPagedMemoryUsage(sim)
+                                       : (int)ceil(100 * (double)sim->memory_usage / sim->memory_size);
+    values[METRICS_FRAMES_USED] = frames_used;
+    values[METRICS_EVICTIONS] = sim->evicted_frame_count - metrics->sampled_evictions;
+    values[METRICS_CONTEXT_SWITCHES] = sim->context_switch_count - metrics->sampled_switches;
+    metrics->sampled_evictions = sim->evicted_frame_count;
+    metrics->sampled_switches = sim->context_switch_count;
+    addMetricsRow(metrics, values);
+}
+
+// Function to make the next scheduling decision and sample it
+int stepSimulation(struct Simulation *sim)
+{
+    int time = sim->current_time;
+    if (!makeDecision(sim))
+        return 0;
+    if (sim->metrics != NULL)
+        sampleMetrics(sim, time);
+    sim->last_decision_time = time;
+    return 1;
+}
+
+// Function to write the summary once the last process has finished
+void finishSimulation(struct Simulation *sim)
+{
+    mergeCoreStats(sim);
+    calculateAverageTurnover(sim);
+    calculateOverhead(sim);
+    calculateDistributions(sim);
+    sim->result.evictions = sim->evicted_frame_count;
+    sim->result.context_switches = sim->context_switch_count;
+    sim->result.migrations = sim->migration_count;
+    sim->result.remote_time = sim->remote_time;
+    sim->result.page_faults = sim->page_fault_count;
+    sim->result.writebacks = sim->writeback_count;
+    sim->result.switch_time = sim->switch_time;
+    sim->result.references = sim->reference_count;
+    sim->result.fault_rate = sim->reference_count > 0 ? (double)sim->page_fault_count / sim->reference_count : 0.0;
+    sim->result.tlb_hit_rate = sim->reference_count > 0 ? (double)sim->tlb_hit_count / sim->reference_count : 0.0;
+    sim->result.makespan = sim->current_time - sim->quantum_time;
+    printSummary(sim);
+    sim->finished = 1;
+}
+
+int schedule(struct Simulation *sim)
+{
+    while (stepSimulation(sim))
+        ;
+    return 0;
+}
+
+// Function to free the processes, queues and memory of a run, which a
+// simulation may still hold if it is freed before it finishes
+void freeSimulationState(struct Simulation *sim)
+{
+    for (int i = 0; i < sim->live_count; i++)
+    {
+        freeFrameList(&sim->live_processes[i]->frames);
+        if (sim->live_processes[i]->refs != NULL)
+            freePageReferences(sim->live_processes[i]->refs);
+        free(sim->live_processes[i]);
+    }
+    free(sim->live_processes);
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        freeReadyQueue(sim->cores[i].ready_processes);
+    }
+    free(sim->cores);
+    freeQueue(sim->waiting_processes);
+    freeQueue(sim->blocked_processes);
+    free(sim->dirty_frames);
+    free(sim->frame_pages);
+    for (int i = 0; sim->tlbs != NULL && i < sim->core_count; i++)
+    {
+        freeTlb(sim->tlbs[i]);
+    }
+    free(sim->tlbs);
+
+    freeExtentTree(sim->contiguousMemory.free_extents);
+    if (sim->contiguousMemory.buddy != NULL)
+        freeBuddyAllocator(sim->contiguousMemory.buddy);
+    freeFramePools(sim->page_table);
+    if (sim->replacement_policy != NULL)
+    {
+        sim->replacement_policy->destroy(sim->replacement_state);
+        freeFrameMap(&sim->frame_map);
+    }
+}
+
+void cleanUp(struct Simulation *sim)
+{
+    if (sim->trace != NULL)
+        closeTrace(sim->trace);
+    freeOutputSink(sim->output);
+    if (sim->metrics != NULL)
+        freeMetrics(sim->metrics);
+    freeSimulationState(sim);
+    if (sim->reference_table != NULL)
+    {
+        freeReferenceTable(sim->reference_table);
+        free((char *)sim->references_file);
+    }
+}
+
+void writeProcessRef(struct Snapshot *snapshot, struct Process *process)
+{
+    writeSnapshotInt(snapshot, process == NULL ? -1 : process->live_index);
+}
+
+struct Process *readProcessRef(struct Snapshot *snapshot)
+{
+    int index = readSnapshotRange(snapshot, -1, snapshot->process_count - 1);
+    return index == -1 ? NULL : snapshot->processes[index];
+}
+
+void saveProcess(struct Snapshot *snapshot, Process *process)
+{
+    writeSnapshotInt(snapshot, process->pid);
+    writeSnapshot(snapshot, process->name, MAX_NAME_LENGTH);
+    writeSnapshotInt(snapshot, process->arrival_time);
+    writeSnapshotInt(snapshot, process->remaining_time);
+    writeSnapshotInt(snapshot, process->status);
+    writeSnapshotInt(snapshot, process->memory_executed_proc_arr_size);
+    writeSnapshotInt(snapshot, process->memory_start_address);
+    writeSnapshotInt(snapshot, process->total_page);
+    writeSnapshotInt(snapshot, process->sum_remaining_time);
+    writeSnapshotInt(snapshot, process->level);
+    writeSnapshotInt(snapshot, process->tickets);
+    writeSnapshotLong(snapshot, process->pass);
+    writeSnapshotInt(snapshot, process->core);
+    writeSnapshotInt(snapshot, process->node);
+    writeSnapshotInt(snapshot, process->ready_at);
+    saveFrameList(snapshot, &process->frames);
+    if (process->refs != NULL)
+        savePageReferences(snapshot, process->refs);
+}
+
+// Function to read a process written by saveProcess(). It is not linked
+// into the executed order yet.
+Process *restoreProcess(struct Simulation *sim, struct Snapshot *snapshot)
+{
+    Process *process = (Process *)malloc(sizeof(Process));
+    if (process == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    process->pid = readSnapshotInt(snapshot);
+    readSnapshot(snapshot, process->name, MAX_NAME_LENGTH);
+    process->name[MAX_NAME_LENGTH - 1] = '\0';
+    process->arrival_time = readSnapshotInt(snapshot);
+    process->remaining_time = readSnapshotInt(snapshot);
+    process->status = (ProcessStatus)readSnapshotRange(snapshot, READY, BLOCKED);
+    process->memory_executed_proc_arr_size = readSnapshotInt(snapshot);
+    process->memory_start_address = readSnapshotRange(snapshot, -1, sim->memory_size - 1);
+    process->total_page = readSnapshotInt(snapshot);
+    process->sum_remaining_time = readSnapshotRange(snapshot, 0, INT_MAX);
+    process->level = readSnapshotRange(snapshot, 0, MLFQ_LEVELS - 1);
+    process->tickets = readSnapshotRange(snapshot, 1, INT_MAX);
+    process->pass = readSnapshotLong(snapshot);
+    process->core = readSnapshotRange(snapshot, -1, sim->core_count - 1);
+    process->node = readSnapshotRange(snapshot, 0, sim->node_count - 1);
+    process->ready_at = readSnapshotRange(snapshot, -1, INT_MAX);
+    restoreFrameList(snapshot, &process->frames, sim->page_num);
+    process->executed_prev = process->executed_next = NULL;
+    process->in_executed_list = 0;
+
+    // The stream is started again from the settings, then moved on to
+    // where it was
+    process->refs = startReferences(sim, process);
+    if (process->refs != NULL)
+        restorePageReferences(snapshot, process->refs, sim->page_num);
+    return process;
+}
+
+// Function to write the whole state of a run between two steps. Returns 1
+// if it cannot be saved.
+int saveSimulation(struct Simulation *sim, struct Snapshot *snapshot)
+{
+    // The snapshot goes at the end, where the trace position can be
+    // refused before anything is written
+    struct Snapshot position = {0};
+    if (saveTracePosition(&position, sim->trace) != 0)
+        return 1;
+    outputFlush(sim->output); // Events up to the snapshot are out before it is used
+
+    writeSnapshot(snapshot, SNAPSHOT_MAGIC, 4);
+    writeSnapshotInt(snapshot, SNAPSHOT_VERSION);
+    writeSnapshotInt(snapshot, (int)SNAPSHOT_BYTE_ORDER);
+
+    // Settings a restored run must share
+    writeSnapshotString(snapshot, sim->memory_strategy->name);
+    writeSnapshotString(snapshot, sim->scheduler_policy->name);
+    writeSnapshotString(snapshot, sim->replacement_policy != NULL ? sim->replacement_policy->name : "");
+    writeSnapshotInt(snapshot, sim->report_evictions);
+    writeSnapshotInt(snapshot, sim->quantum_time);
+    writeSnapshotInt(snapshot, sim->memory_size);
+    writeSnapshotInt(snapshot, sim->page_size);
+    writeSnapshotInt(snapshot, sim->core_count);
+    writeSnapshotInt(snapshot, sim->migration_cost);
+    writeSnapshotInt(snapshot, sim->node_count);
+    writeSnapshotInt(snapshot, sim->numa_policy);
+    writeSnapshotInt(snapshot, sim->remote_cost);
+    writeSnapshotInt(snapshot, sim->fault_cost);
+    writeSnapshotInt(snapshot, sim->writeback_cost);
+    writeSnapshotInt(snapshot, sim->switch_cost);
+    writeSnapshotInt(snapshot, sim->reference_pattern);
+    writeSnapshotString(snapshot, sim->references_file);
+    writeSnapshotInt(snapshot, sim->reference_rate);
+    writeSnapshotInt(snapshot, sim->tlb_entries);
+    writeSnapshotInt(snapshot, sim->tlb_ways);
+
+    writeSnapshotInt(snapshot, sim->current_time);
+    writeSnapshotInt(snapshot, sim->process_count);
+    writeSnapshotInt(snapshot, sim->memory_usage);
+    writeSnapshotInt(snapshot, sim->total_process);
+    writeSnapshotInt(snapshot, sim->make_span);
+    writeSnapshotInt(snapshot, sim->total_turnover);
+    writeSnapshotInt(snapshot, sim->next_pid);
+    writeSnapshotInt(snapshot, sim->evicted_frame_count);
+    writeSnapshotInt(snapshot, sim->context_switch_count);
+    writeSnapshotInt(snapshot, sim->migration_count);
+    writeSnapshotInt(snapshot, sim->remote_time);
+    writeSnapshotInt(snapshot, sim->page_fault_count);
+    writeSnapshotInt(snapshot, sim->writeback_count);
+    writeSnapshotInt(snapshot, sim->switch_time);
+    writeSnapshotLong(snapshot, sim->reference_count);
+    writeSnapshotLong(snapshot, sim->tlb_hit_count);
+    writeSnapshotInt(snapshot, sim->last_decision_time);
+    writeSnapshotInt(snapshot, sim->ready_process_count);
+    writeSnapshotInt(snapshot, sim->finished);
+    writeSnapshot(snapshot, &sim->result, sizeof(sim->result));
+
+    // The processes, then every structure that refers to them
+    writeSnapshotInt(snapshot, sim->live_count);
+    for (int i = 0; i < sim->live_count; i++)
+    {
+        saveProcess(snapshot, sim->live_processes[i]);
+    }
+    int executed = 0;
+    for (Process *process = sim->executed_proc_front; process != NULL; process = process->executed_next)
+        executed++;
+    writeSnapshotInt(snapshot, executed);
+    for (Process *process = sim->executed_proc_front; process != NULL; process = process->executed_next)
+    {
+        writeProcessRef(snapshot, process);
+    }
+    for (int i = 0; i < sim->core_count; i++)
+    {
+        writeProcessRef(snapshot, sim->cores[i].current_process);
+        saveReadyQueue(snapshot, sim->cores[i].ready_processes);
+        writeSnapshotLong(snapshot, sim->cores[i].busy_time);
+        writeSnapshot(snapshot, &sim->cores[i].turnaround_stats, sizeof(sim->cores[i].turnaround_stats));
+        writeSnapshot(snapshot, &sim->cores[i].overhead_stats, sizeof(sim->cores[i].overhead_stats));
+        writeSnapshot(snapshot, &sim->cores[i].wait_stats, sizeof(sim->cores[i].wait_stats));
+    }
+    writeSnapshotInt(snapshot, sim->blocked_processes->size);
+    for (int i = 0; i < sim->blocked_processes->size; i++)
+    {
+        writeProcessRef(snapshot, sim->blocked_processes->items[(sim->blocked_processes->front + i) %
+                                                                sim->blocked_processes->capacity]);
+    }
+
+    saveExtentTree(snapshot, sim->contiguousMemory.free_extents);
+    writeSnapshotInt(snapshot, sim->contiguousMemory.next_fit_cursor);
+    writeSnapshotInt(snapshot, sim->contiguousMemory.buddy != NULL);
+    if (sim->contiguousMemory.buddy != NULL)
+        saveBuddyAllocator(snapshot, sim->contiguousMemory.buddy);
+    saveFramePools(snapshot, sim->page_table);
+    if (sim->dirty_frames != NULL)
+        writeSnapshotArray(snapshot, sim->dirty_frames, sim->page_num, 1);
+    if (sim->frame_pages != NULL)
+    {
+        writeSnapshotArray(snapshot, sim->frame_pages, sim->page_num, sizeof(struct FramePage));
+        for (int i = 0; i < sim->core_count; i++)
+        {
+            saveTlb(snapshot, sim->tlbs[i]);
+        }
+    }
+    if (sim->replacement_policy != NULL)
+    {
+        saveFrameMap(snapshot, &sim->frame_map);
+        sim->replacement_policy->save(sim->replacement_state, snapshot);
+    }
+
+    writeSnapshot(snapshot, position.data, position.length);
+    free(position.data);
+    return 0;
+}
+
+// Function to read the state written by saveSimulation() into a run with
+// the same settings and trace, replacing its own state. Returns 1 if the
+// snapshot cannot be restored, leaving the run as it was.
+int restoreSimulation(struct Simulation *sim, const void *data, size_t size)
+{
+    struct Snapshot snapshot = {(char *)data, size, size, 0, 0, NULL, 0};
+    char magic[4];
+    readSnapshot(&snapshot, magic, 4);
+    if (memcmp(magic, SNAPSHOT_MAGIC, 4) != 0 || readSnapshotInt(&snapshot) != SNAPSHOT_VERSION ||
+        readSnapshotInt(&snapshot) != (int)SNAPSHOT_BYTE_ORDER || snapshot.failed)
+    {
+        fprintf(stderr, "Not a snapshot, or one written by another version or kind of machine\n");
+        return 1;
+    }
+    if (!matchSnapshotString(&snapshot, sim->memory_strategy->name) ||
+        !matchSnapshotString(&snapshot, sim->scheduler_policy->name) ||
+        !matchSnapshotString(&snapshot, sim->replacement_policy != NULL ? sim->replacement_policy->name : "") ||
+        readSnapshotInt(&snapshot) != sim->report_evictions ||
+        readSnapshotInt(&snapshot) != sim->quantum_time ||
+        readSnapshotInt(&snapshot) != sim->memory_size ||
+        readSnapshotInt(&snapshot) != sim->page_size ||
+        readSnapshotInt(&snapshot) != sim->core_count ||
+        readSnapshotInt(&snapshot) != sim->migration_cost ||
+        readSnapshotInt(&snapshot) != sim->node_count ||
+        readSnapshotInt(&snapshot) != sim->numa_policy ||
+        readSnapshotInt(&snapshot) != sim->remote_cost ||
+        readSnapshotInt(&snapshot) != sim->fault_cost ||
+        readSnapshotInt(&snapshot) != sim->writeback_cost ||
+        readSnapshotInt(&snapshot) != sim->switch_cost ||
+        readSnapshotInt(&snapshot) != sim->reference_pattern ||
+        !matchSnapshotString(&snapshot, sim->references_file) ||
+        readSnapshotInt(&snapshot) != sim->reference_rate ||
+        readSnapshotInt(&snapshot) != sim->tlb_entries ||
+        readSnapshotInt(&snapshot) != sim->tlb_ways)
+    {
+        fprintf(stderr, "The snapshot was taken with different settings\n");
+        return 1;
+    }
+
+    // Build the state aside so a damaged snapshot changes nothing
+    struct Simulation restored = *sim;
+    createSimulationState(&restored, &sim->frame_map);
+    restored.current_time = readSnapshotInt(&snapshot);
+    restored.process_count = readSnapshotInt(&snapshot);
+    restored.memory_usage = readSnapshotInt(&snapshot);
+    restored.total_process = readSnapshotRange(&snapshot, 0, INT_MAX);
+    restored.make_span = readSnapshotInt(&snapshot);
+    restored.total_turnover = readSnapshotInt(&snapshot);
+    restored.next_pid = readSnapshotInt(&snapshot);
+    restored.evicted_frame_count = readSnapshotInt(&snapshot);
+    restored.context_switch_count = readSnapshotInt(&snapshot);
+    restored.migration_count = readSnapshotInt(&snapshot);
+    restored.remote_time = readSnapshotInt(&snapshot);
+    restored.page_fault_count = readSnapshotInt(&snapshot);
+    restored.writeback_count = readSnapshotInt(&snapshot);
+    restored.switch_time = readSnapshotInt(&snapshot);
+    restored.reference_count = readSnapshotLong(&snapshot);
+    restored.tlb_hit_count = readSnapshotLong(&snapshot);
+    restored.last_decision_time = readSnapshotInt(&snapshot);
+    restored.ready_process_count = readSnapshotInt(&snapshot);
+    restored.finished = readSnapshotRange(&snapshot, 0, 1);
+    readSnapshot(&snapshot, &restored.result, sizeof(restored.result));
+
+    // Every process takes far more than an int, which bounds the count
+    int live_count = readSnapshotRange(&snapshot, 0, (int)((size - snapshot.offset) / sizeof(int)));
+    for (int i = 0; i < live_count && !snapshot.failed; i++)
+    {
+        addLiveProcess(&restored, restoreProcess(&restored, &snapshot));
+    }
+    if (restored.process_count != restored.live_count)
+        snapshot.failed = 1;
+    snapshot.processes = restored.live_processes;
+    snapshot.process_count = restored.live_count;
+
+    restored.executed_proc_front = restored.executed_proc_rear = NULL;
+    int executed = readSnapshotRange(&snapshot, 0, restored.live_count);
+    for (int i = 0; i < executed; i++)
+    {
+        Process *process = readProcessRef(&snapshot);
+        if (process == NULL || process->in_executed_list)
+            snapshot.failed = 1;
+        else
+            addToExecutedProcList(&restored, process);
+    }
+    for (int i = 0; i < restored.core_count; i++)
+    {
+        restored.cores[i].current_process = readProcessRef(&snapshot);
+        restoreReadyQueue(&snapshot, restored.cores[i].ready_processes);
+        restored.cores[i].busy_time = readSnapshotLong(&snapshot);
+        readSnapshot(&snapshot, &restored.cores[i].turnaround_stats, sizeof(restored.cores[i].turnaround_stats));
+        readSnapshot(&snapshot, &restored.cores[i].overhead_stats, sizeof(restored.cores[i].overhead_stats));
+        readSnapshot(&snapshot, &restored.cores[i].wait_stats, sizeof(restored.cores[i].wait_stats));
+    }
+    int blocked = readSnapshotRange(&snapshot, 0, restored.live_count);
+    for (int i = 0; i < blocked; i++)
+    {
+        Process *process = readProcessRef(&snapshot);
+        if (process == NULL || process->status != BLOCKED)
+            snapshot.failed = 1;
+        else
+            enqueue(restored.blocked_processes, process);
+    }
+
+    restoreExtentTree(&snapshot, restored.contiguousMemory.free_extents, restored.memory_size);
+    restored.contiguousMemory.next_fit_cursor = readSnapshotInt(&snapshot);
+    if (readSnapshotRange(&snapshot, 0, 1))
+        restoreBuddyAllocator(&snapshot, buddyMemory(&restored));
+    restoreFramePools(&snapshot, restored.page_table);
+    if (!snapshot.failed && restored.memory_strategy->holders_valid != NULL &&
+        !restored.memory_strategy->holders_valid(&restored))
+        snapshot.failed = 1;
+    if (restored.dirty_frames != NULL)
+        readSnapshotArray(&snapshot, restored.dirty_frames, restored.page_num, 1);
+    if (restored.frame_pages != NULL)
+    {
+        readSnapshotArray(&snapshot, restored.frame_pages, restored.page_num, sizeof(struct FramePage));
+
+        // A frame a process holds is empty or holds one of its own pages
+        for (int i = 0; i < restored.live_count && !snapshot.failed; i++)
+        {
+            Process *process = restored.live_processes[i];
+            for (int j = 0; j < process->frames.count; j++)
+            {
+                struct FrameRun *run = &process->frames.runs[j];
+                for (int frame = run->start; run->start != -1 && frame < run->start + run->length; frame++)
+                {
+                    struct FramePage *held = &restored.frame_pages[frame];
+                    if (held->pid != -1 &&
+                        (held->pid != process->pid || held->page < 0 || held->page >= process->refs->pages))
+                        snapshot.failed = 1;
+                }
+            }
+        }
+        for (int i = 0; i < restored.core_count; i++)
+        {
+            restoreTlb(&snapshot, restored.tlbs[i]);
+        }
+    }
+    if (restored.replacement_policy != NULL)
+    {
+        restoreFrameMap(&snapshot, &restored.frame_map);
+
+        // The map names the owner and slot of exactly the frames processes hold
+        int held = 0;
+        for (int i = 0; i < restored.live_count && !snapshot.failed; i++)
+        {
+            Process *process = restored.live_processes[i];
+            int slot = 0;
+            for (int j = 0; j < process->frames.count; j++)
+            {
+                struct FrameRun *run = &process->frames.runs[j];
+                for (int k = 0; run->start != -1 && k < run->length; k++)
+                {
+                    if (restored.frame_map.owner[run->start + k] != process || restored.frame_map.page[run->start + k] != slot + k)
+                        snapshot.failed = 1;
+                    held++;
+                }
+                slot += run->length;
+            }
+        }
+        if (held != countHeldFrames(&restored.frame_map))
+            snapshot.failed = 1;
+        if (!snapshot.failed)
+            restored.replacement_policy->restore(restored.replacement_state, &snapshot, &restored.frame_map);
+    }
+
+    struct TracePosition position;
+    readSnapshot(&snapshot, &position, sizeof(position));
+    if (!snapshot.failed && snapshot.offset != snapshot.length)
+        snapshot.failed = 1;
+    if (snapshot.failed)
+        fprintf(stderr, "The snapshot is damaged\n");
+    if (snapshot.failed || checkTracePosition(sim->trace, &position) != 0)
+    {
+        freeSimulationState(&restored);
+        return 1;
+    }
+
+    freeSimulationState(sim);
+    *sim = restored;
+    seekTrace(sim->trace, &position);
+    if (sim->metrics != NULL)
+    {
+        // The first sample counts from the snapshot
+        sim->metrics->sampled_evictions = sim->evicted_frame_count;
+        sim->metrics->sampled_switches = sim->context_switch_count;
+    }
+    return 0;
+}
+
+// Function to resolve the settings of a simulation from its configuration.
+// Returns 0 on success.
+int configureSimulation(struct Simulation *sim, const struct sched_config *config)
+{
+    memset(sim, 0, sizeof(*sim));
+    if (config->memory_strategy == NULL)
+    {
+        fprintf(stderr, "No memory strategy given\n");
+        return 1;
+    }
+    sim->memory_strategy = findMemoryStrategy(config->memory_strategy);
+    if (sim->memory_strategy == NULL)
+    {
+        fprintf(stderr, "Unknown memory strategy %s\n", config->memory_strategy);
+        return 1;
+    }
+    sim->scheduler_policy = findSchedulerPolicy(config->scheduler_policy == NULL ? "rr" : config->scheduler_policy);
+    if (sim->scheduler_policy == NULL)
+    {
+        fprintf(stderr, "Unknown scheduling policy %s\n", config->scheduler_policy);
+        return 1;
+    }
+    if (config->replacement_policy != NULL)
+    {
+        // lru keeps the default of evicting whole least recently run processes
+        sim->report_evictions = 1;
+        sim->replacement_policy = strcmp(config->replacement_policy, "lru") == 0 ? NULL : findReplacementPolicy(config->replacement_policy);
+        if (sim->replacement_policy == NULL && strcmp(config->replacement_policy, "lru") != 0)
+        {
+            fprintf(stderr, "Unknown replacement policy %s\n", config->replacement_policy);
+            return 1;
+        }
+    }
+    if (config->memory_size <= 0 || config->page_size <= 0 || config->page_size > config->memory_size)
+    {
+        fprintf(stderr, "Memory size and page size must be positive, with pages no larger than the memory\n");
+        return 1;
+    }
+    if (config->quantum <= 0)
+    {
+        fprintf(stderr, "The quantum must be positive\n");
+        return 1;
+    }
+    if (config->core_count <= 0 || config->migration_cost < 0)
+    {
+        fprintf(stderr, "The number of cores must be positive and the migration cost not negative\n");
+        return 1;
+    }
+    sim->numa_policy = findNumaPolicy(config->numa_policy == NULL ? "local-first" : config->numa_policy);
+    if (sim->numa_policy == -1)
+    {
+        fprintf(stderr, "Unknown NUMA policy %s\n", config->numa_policy);
+        return 1;
+    }
+    if (config->node_count <= 0 || config->remote_cost < 0 || config->remote_cost >= config->quantum)
+    {
+        fprintf(stderr, "The number of NUMA nodes must be positive and the remote cost at least 0 and less than the quantum\n");
+        return 1;
+    }
+    // Only the strategies that hand out frames have nodes to place them on
+    if (config->node_count > 1 && !sim->memory_strategy->uses_frames)
+    {
+        fprintf(stderr, "NUMA nodes apply to paged and virtual memory only\n");
+        return 1;
+    }
+    if (config->node_count > config->memory_size / config->page_size)
+    {
+        fprintf(stderr, "There cannot be more NUMA nodes than frames\n");
+        return 1;
+    }
+    if (config->fault_cost < 0 || config->writeback_cost < 0 || config->switch_cost < 0)
+    {
+        fprintf(stderr, "The fault, write-back and context switch costs must not be negative\n");
+        return 1;
+    }
+    // Only virtual memory brings pages in as processes run
+    if ((config->fault_cost > 0 || config->writeback_cost > 0) && !sim->memory_strategy->is_virtual)
+    {
+        fprintf(stderr, "Fault and write-back costs apply to virtual memory only\n");
+        return 1;
+    }
+
+    sim->reference_pattern = -1;
+    if (config->references != NULL || config->references_file != NULL)
+    {
+        sim->reference_pattern = findReferencePattern(config->references == NULL ? "sequential" : config->references);
+        if (sim->reference_pattern == -1)
+        {
+            fprintf(stderr, "Unknown reference pattern %s\n", config->references);
+            return 1;
+        }
+        // Only virtual memory brings pages in as they are referenced
+        if (!sim->memory_strategy->is_virtual)
+        {
+            fprintf(stderr, "Reference streams apply to virtual memory only\n");
+            return 1;
+        }
+    }
+    if (config->reference_rate <= 0 ||
+        (long long)config->reference_rate * config->quantum > INT_MAX / WORKING_SET_QUANTA)
+    {
+        fprintf(stderr, "The reference rate must be positive, and its product with the quantum not too large\n");
+        return 1;
+    }
+    if (config->tlb_entries <= 0 || config->tlb_ways <= 0 || config->tlb_entries % config->tlb_ways != 0)
+    {
+        fprintf(stderr, "The TLB entries and ways must be positive, with the entries a multiple of the ways\n");
+        return 1;
+    }
+
+    sim->quantum_time = config->quantum;
+    sim->memory_size = config->memory_size;
+    sim->page_size = config->page_size;
+    sim->page_num = sim->memory_size / sim->page_size; // A partial page at the end of the memory is not usable
+    sim->frames_as_ranges = config->frames_as_ranges;
+    sim->policy_seed = config->seed;
+    sim->report_skipped = config->report_skipped;
+    sim->report_percentiles = config->report_percentiles;
+    sim->core_count = config->core_count;
+    sim->migration_cost = config->migration_cost;
+    sim->node_count = config->node_count;
+    sim->remote_cost = config->remote_cost;
+    sim->fault_cost = config->fault_cost;
+    sim->writeback_cost = config->writeback_cost;
+    sim->switch_cost = config->switch_cost;
+    sim->reference_rate = config->reference_rate;
+    sim->tlb_entries = config->tlb_entries;
+    sim->tlb_ways = config->tlb_ways;
+    sim->references_file = "";
+    sim->reference_table = NULL;
+    if (sim->reference_pattern != -1 && config->references_file != NULL)
+    {
+        sim->reference_table = readReferenceTable(config->references_file);
+        if (sim->reference_table == NULL)
+            return 1;
+        sim->references_file = strdup(config->references_file);
+        if (sim->references_file == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    sim->metrics_fd = config->metrics_fd;
+    sim->metrics_binary = config->metrics_binary;
+    sim->metrics_every = config->metrics_every > 0 ? config->metrics_every : config->quantum;
+    return 0;
+}
+
+void sched_default_config(struct sched_config *config)
+{
+    config->memory_strategy = NULL;
+    config->quantum = 0;
+    config->memory_size = DEFAULT_MEMORY_SIZE;
+    config->page_size = DEFAULT_PAGE_SIZE;
+    config->scheduler_policy = "rr";
+    config->seed = 1;
+    config->replacement_policy = NULL;
+    config->frames_as_ranges = 0;
+    config->report_skipped = 1;
+    config->report_percentiles = 0;
+    config->core_count = 1;
+    config->migration_cost = 0;
+    config->node_count = 1;
+    config->numa_policy = "local-first";
+    config->remote_cost = 0;
+    config->fault_cost = 0;
+    config->writeback_cost = 0;
+    config->switch_cost = 0;
+    config->references = NULL;
+    config->references_file = NULL;
+    config->reference_rate = 10;
+    config->tlb_entries = 64;
+    config->tlb_ways = 4;
+    config->metrics_fd = -1;
+    config->metrics_binary = 0;
+    config->metrics_every = 0;
+    config->output_fd = STDOUT_FILENO;
+}
+
+sched_ctx *sched_create(const struct sched_config *config)
+{
+    sched_ctx *ctx = (sched_ctx *)malloc(sizeof(sched_ctx));
+    if (ctx == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    if (configureSimulation(&ctx->sim, config) != 0)
+    {
+        free(ctx);
+        return NULL;
+    }
+    startSimulation(&ctx->sim, config->output_fd);
+    return ctx;
+}
+
+// Check that the simulation is waiting for its trace
+int canLoadTrace(sched_ctx *ctx)
+{
+    if (ctx->sim.trace != NULL)
+    {
+        fprintf(stderr, "A trace has already been loaded\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Processes are read from the file one line at a time as their arrival
+// time comes up, so only live processes are in memory.
+int sched_load(sched_ctx *ctx, const char *filename)
+{
+    if (!canLoadTrace(ctx))
+        return 1;
+    ctx->sim.trace = openTrace(filename);
+    if (ctx->sim.trace == NULL)
+        return 1;
+    return 0;
+}
+
+int sched_load_trace(sched_ctx *ctx, const sched_trace *trace)
+{
+    if (!canLoadTrace(ctx))
+        return 1;
+    ctx->sim.trace = openTraceRecords(trace->records, trace->count);
+    return 0;
+}
+
+int sched_step(sched_ctx *ctx)
+{
+    if (ctx->sim.trace == NULL)
+        return -1;
+    return stepSimulation(&ctx->sim);
+}
+
+int sched_run(sched_ctx *ctx)
+{
+    if (ctx->sim.trace == NULL)
+        return 1;
+    schedule(&ctx->sim);
+    return 0;
+}
+
+int sched_time(const sched_ctx *ctx)
+{
+    return ctx->sim.current_time;
+}
+
+int sched_result(const sched_ctx *ctx, struct sched_result *result)
+{
+    if (!ctx->sim.finished)
+        return -1;
+    *result = ctx->sim.result;
+    return 0;
+}
+
+double sched_core_utilisation(const sched_ctx *ctx, int core)
+{
+    if (!ctx->sim.finished || core < 0 || core >= ctx->sim.core_count)
+        return -1.0;
+    return coreUtilisation((struct Simulation *)&ctx->sim, core);
+}
+
+int sched_snapshot(sched_ctx *ctx, void **data, size_t *size)
+{
+    if (ctx->sim.trace == NULL)
+        return 1;
+    struct Snapshot snapshot = {0};
+    if (saveSimulation(&ctx->sim, &snapshot) != 0)
+        return 1;
+    *data = snapshot.data;
+    *size = snapshot.length;
+    return 0;
+}
+
+int sched_restore(sched_ctx *ctx, const void *data, size_t size)
+{
+    if (ctx->sim.trace == NULL)
+        return 1;
+    return restoreSimulation(&ctx->sim, data, size);
+}
+
+void sched_destroy(sched_ctx *ctx)
+{
+    cleanUp(&ctx->sim);
+    free(ctx);
+}
+
+sched_trace *sched_trace_read(const char *filename)
+{
+    size_t count;
+    struct TraceRecord *records = loadTrace(filename, &count);
+    if (records == NULL)
+        return NULL;
+    sched_trace *trace = (sched_trace *)malloc(sizeof(sched_trace));
+    if (trace == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    trace->records = records;
+    trace->count = count;
+    return trace;
+}
+
+size_t sched_trace_size(const sched_trace *trace)
+{
+    return trace->count;
+}
+
+void sched_trace_free(sched_trace *trace)
+{
+    free(trace->records);
+    free(trace);
+}
+
+int sched_convert_trace(const char *input_name, const char *output_name)
+{
+    return convertTrace(input_name, output_name);
+}
@@ -0,0 +1,160 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Public interface of libsched, the round robin scheduler and memory
+// simulator behind allocate. Every simulation lives in its own sched_ctx,
+// so any number of them can exist at once and run on different threads.
+// Errors are reported on stderr and by the return value.
+
+#if defined(__GNUC__)
+#define SCHED_API __attribute__((visibility("default")))
+#else
+#define SCHED_API
+#endif
+
+typedef struct sched_ctx sched_ctx;
+
+// A trace read into memory once, which any number of simulations can
+// replay at the same time. It must outlive every simulation loaded from it.
+typedef struct sched_trace sched_trace;
+
+// Define a structure to represent the settings of a simulation.
+// Fill it with sched_default_config() and change what is needed.
+struct sched_config
+{
+    const char *memory_strategy;    // infinite, first-fit, best-fit, next-fit, buddy, paged or virtual
+    int quantum;                    // Quantum length, must be positive
+    int memory_size;                // Memory size in KB
+    int page_size;                  // Page/frame size in KB for paged and virtual
+    const char *scheduler_policy;   // rr, srtf, mlfq, lottery or stride
+    uint64_t seed;                  // Seed for the lottery policy
+    const char *replacement_policy; // NULL, or lru, clock, lfu, arc or ws; non-NULL also reports evictions
+    int frames_as_ranges;           // 1 to print frame lists as ranges
+    int report_skipped;             // 1 to say on stderr which processes are too large for the memory
+    int report_percentiles;         // 1 to add the spread of turnaround, overhead and waiting time to the summary
+    int core_count;                 // Number of CPUs, each with its own ready queue
+    int migration_cost;             // Time added to a process each time it runs on a different core
+    int node_count;                 // NUMA nodes the frames of paged and virtual memory are split into
+    const char *numa_policy;        // local-first, interleave or bind
+    int remote_cost;                // Part of a quantum lost by a process with every frame on another node
+    int fault_cost;                 // Time to bring a page into a frame under virtual; the process blocks meanwhile
+    int writeback_cost;             // Time to write back a dirty frame being evicted under virtual
+    int switch_cost;                // Time every decision in which a core changes process takes
+    const char *references;         // NULL, or sequential, zipf or loop: every process under virtual references its pages in that pattern
+    const char *references_file;    // NULL, or a file of "name page page ..." lines giving the references of the processes it names
+    int reference_rate;             // References a process makes per unit of running time under a reference stream
+    int tlb_entries;                // Entries of the TLB of every core under reference streams
+    int tlb_ways;                   // Ways of each set of the TLB; the entries are a multiple of them
+    int output_fd;                  // Where the event lines are written, -1 to drop them
+    int metrics_fd;                 // Where a sampled time series is written, -1 for none
+    int metrics_binary;             // 1 to write the time series in binary columnar form instead of CSV
+    int metrics_every;              // Simulated time between samples, 0 for every quantum
+};
+
+// Define a structure to represent how one measure is spread over the
+// finished processes. Percentiles are within 1/64 of the exact value.
+struct sched_distribution
+{
+    double mean;
+    double stddev;
+    double p50;
+    double p95;
+    double p99;
+    double p999;
+};
+
+// Define a structure to represent the summary of a finished simulation
+struct sched_result
+{
+    double average_turnover; // Rounded up to a whole time unit
+    double max_overhead;
+    double average_overhead;
+    int evictions;           // Frames taken from unfinished processes
+    int context_switches;    // Times a core was given to a different process
+    int migrations;          // Times a process ran on a different core than before
+    int remote_time;         // Running time lost to frames on other nodes
+    int page_faults;         // Pages brought into frames under virtual
+    int writebacks;          // Dirty frames written back as they were evicted
+    int switch_time;         // Time spent changing the process of a core
+    long long references;    // Pages referenced by the reference streams
+    double fault_rate;       // Share of the references that faulted
+    double tlb_hit_rate;     // Share of the references the TLB translated
+    int makespan;
+    struct sched_distribution turnaround;
+    struct sched_distribution overhead; // Turnaround over service time
+    struct sched_distribution wait;     // Turnaround less service time
+};
+
+// Function to fill in the defaults: no memory strategy, no quantum,
+// 2048 KB of memory in 4 KB pages on one NUMA node, rr, seed 1, one
+// core, no reference streams (10 references per time unit and a 64-entry
+// 4-way TLB once they are on), events on stdout and no time series
+SCHED_API void sched_default_config(struct sched_config *config);
+
+// Function to create a simulation. Returns NULL if the settings are invalid.
+SCHED_API sched_ctx *sched_create(const struct sched_config *config);
+
+// Function to give the simulation its processes, read from a text or
+// binary trace file as they arrive. Returns 0 on success.
+SCHED_API int sched_load(sched_ctx *ctx, const char *filename);
+
+// Function to give the simulation its processes from a trace in memory.
+// Returns 0 on success.
+SCHED_API int sched_load_trace(sched_ctx *ctx, const sched_trace *trace);
+
+// Function to make the next scheduling decision, which may cover several
+// quanta when nothing can change in between. Returns 1 while the
+// simulation goes on, 0 once every process has finished and the summary
+// has been written, and -1 if no trace has been loaded.
+SCHED_API int sched_step(sched_ctx *ctx);
+
+// Function to step until every process has finished. Returns 0 on success.
+SCHED_API int sched_run(sched_ctx *ctx);
+
+// Function to get the current simulated time
+SCHED_API int sched_time(const sched_ctx *ctx);
+
+// Function to get the summary of a finished simulation.
+// Returns 0 on success and -1 if it has not finished.
+SCHED_API int sched_result(const sched_ctx *ctx, struct sched_result *result);
+
+// Function to get the share of the makespan a core of a finished
+// simulation spent running processes, between 0 and 1. Returns -1 if it
+// has not finished or there is no such core.
+SCHED_API double sched_core_utilisation(const sched_ctx *ctx, int core);
+
+// Function to capture the whole state of a simulation between two steps,
+// including how far it has read its trace, so it can be resumed later or
+// branched any number of times. Events so far are written out first. The
+// snapshot is malloc'd into *data and is the caller's to free. Returns 0
+// on success; a trace read from a pipe cannot be captured.
+SCHED_API int sched_snapshot(sched_ctx *ctx, void **data, size_t *size);
+
+// Function to put a simulation in the state captured by sched_snapshot(),
+// whatever it was doing before. It must have the same memory strategy,
+// quantum, memory and page size, cores, migration cost and scheduling and
+// replacement policies, and have loaded the same trace. Snapshots are
+// only read back on the kind of machine that wrote them. Returns 0 on
+// success; on failure the simulation is left as it was.
+SCHED_API int sched_restore(sched_ctx *ctx, const void *data, size_t size);
+
+// Function to free a simulation and flush any events and samples still
+// buffered
+SCHED_API void sched_destroy(sched_ctx *ctx);
+
+// Function to read a whole trace file into memory. Returns NULL on failure.
+SCHED_API sched_trace *sched_trace_read(const char *filename);
+
+// Function to get the number of processes in a trace
+SCHED_API size_t sched_trace_size(const sched_trace *trace);
+
+SCHED_API void sched_trace_free(sched_trace *trace);
+
+// Function to convert a text trace into the binary trace format.
+// Returns 0 on success.
+SCHED_API int sched_convert_trace(const char *input_name, const char *output_name);
+
+#endif
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Snapshot layout: "RRSS", u32 version, u32 byte-order mark, then the
+// sections written by saveSimulation() in order. Values are stored as they
+// are in memory, so restoring is mostly copying arrays back; a snapshot is
+// read on the kind of machine that wrote it, which the byte-order mark and
+// the version check.
+#define SNAPSHOT_MAGIC "RRSS"
+#define SNAPSHOT_VERSION 10
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_INITIAL_CAPACITY 4096
+
+struct Process;
+
+// Define a structure to represent a snapshot being written or read. A read
+// that runs past the end or meets a value out of range marks the snapshot
+// as failed and yields zeros, so loading carries on safely to the end and
+// is checked once. Processes are named by their index in the table of live
+// processes written first.
+struct Snapshot
+{
+    char *data;
+    size_t length;              // Bytes written, or the size of the snapshot being read
+    size_t capacity;            // Bytes allocated while writing
+    size_t offset;              // Read cursor
+    int failed;                 // 1 once a read has gone wrong
+    struct Process **processes; // Live processes by index, while reading
+    int process_count;
+};
+
+// Function to append bytes to a snapshot being written
+void writeSnapshot(struct Snapshot *snapshot, const void *bytes, size_t size)
+{
+    if (snapshot->length + size > snapshot->capacity)
+    {
+        size_t capacity = snapshot->capacity ? snapshot->capacity : SNAPSHOT_INITIAL_CAPACITY;
+        while (capacity < snapshot->length + size)
+            capacity *= 2;
+        snapshot->data = (char *)realloc(snapshot->data, capacity);
+        if (snapshot->data == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        snapshot->capacity = capacity;
+    }
+    if (size > 0)
+        memcpy(snapshot->data + snapshot->length, bytes, size);
+    snapshot->length += size;
+}
+
+// Function to read bytes from a snapshot, or zeros once it has failed
+void readSnapshot(struct Snapshot *snapshot, void *bytes, size_t size)
+{
+    if (size == 0)
+        return;
+    if (snapshot->failed || size > snapshot->length - snapshot->offset)
+    {
+        snapshot->failed = 1;
+        memset(bytes, 0, size);
+        return;
+    }
+    memcpy(bytes, snapshot->data + snapshot->offset, size);
+    snapshot->offset += size;
+}
+
+void writeSnapshotInt(struct Snapshot *snapshot, int value)
+{
+    writeSnapshot(snapshot, &value, sizeof(value));
+}
+
+int readSnapshotInt(struct Snapshot *snapshot)
+{
+    int value;
+    readSnapshot(snapshot, &value, sizeof(value));
+    return value;
+}
+
+void writeSnapshotLong(struct Snapshot *snapshot, long long value)
+{
+    writeSnapshot(snapshot, &value, sizeof(value));
+}
+
+long long readSnapshotLong(struct Snapshot *snapshot)
+{
+    long long value;
+    readSnapshot(snapshot, &value, sizeof(value));
+    return value;
+}
+
+// Function to read an int that must lie between low and high
+int readSnapshotRange(struct Snapshot *snapshot, int low, int high)
+{
+    int value = readSnapshotInt(snapshot);
+    if (value < low || value > high)
+    {
+        snapshot->failed = 1;
+        return low;
+    }
+    return value;
+}
+
+// Function to write a NUL-terminated string
+void writeSnapshotString(struct Snapshot *snapshot, const char *text)
+{
+    writeSnapshotInt(snapshot, (int)strlen(text));
+    writeSnapshot(snapshot, text, strlen(text));
+}
+
+// Function to check that the next string in the snapshot is the given one
+int matchSnapshotString(struct Snapshot *snapshot, const char *text)
+{
+    int length = readSnapshotInt(snapshot);
+    if (snapshot->failed || length != (int)strlen(text) || (size_t)length > snapshot->length - snapshot->offset)
+        return 0;
+    int match = memcmp(snapshot->data + snapshot->offset, text, length) == 0;
+    snapshot->offset += length;
+    return match;
+}
+
+// Function to write an array of count elements, led by its count
+void writeSnapshotArray(struct Snapshot *snapshot, const void *array, int count, size_t size)
+{
+    writeSnapshotInt(snapshot, count);
+    writeSnapshot(snapshot, array, count * size);
+}
+
+// Function to read an array written by writeSnapshotArray() into one of
+// exactly count elements
+void readSnapshotArray(struct Snapshot *snapshot, void *array, int count, size_t size)
+{
+    if (readSnapshotInt(snapshot) != count)
+        snapshot->failed = 1;
+    readSnapshot(snapshot, array, count * size);
+}
+
+// Written and read by the simulator, which knows the process table
+void writeProcessRef(struct Snapshot *snapshot, struct Process *process);
+struct Process *readProcessRef(struct Snapshot *snapshot);
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Histogram layout: every power of two from 2^HISTOGRAM_MIN_EXPONENT up is
+// cut into 2^HISTOGRAM_SUB_BITS equal buckets, so a bucket is never wider
+// than 1/64 of its values (and whole numbers below 64 get one each).
+// Smaller values, including zero, share one count; larger ones go in the
+// last bucket.
+#define HISTOGRAM_SUB_BITS 6
+#define HISTOGRAM_MIN_EXPONENT -8
+#define HISTOGRAM_EXPONENTS 48
+#define HISTOGRAM_BUCKETS (HISTOGRAM_EXPONENTS << HISTOGRAM_SUB_BITS)
+
+// Define a structure to represent a log-linear histogram of values. Its
+// size is fixed whatever the number of values, and two histograms merge by
+// adding their counts.
+struct Histogram
+{
+    uint64_t small_count; // Values below 2^HISTOGRAM_MIN_EXPONENT
+    uint64_t counts[HISTOGRAM_BUCKETS];
+};
+
+// Define a structure to represent the running statistics of one measure:
+// Welford's mean and sum of squared deviations, the exact sum, the extremes
+// and a histogram for the percentiles
+struct RunningStats
+{
+    long long count;
+    double sum;
+    double mean;
+    double m2; // Sum of squared deviations from the mean
+    double min;
+    double max;
+    struct Histogram histogram;
+};
+
+void initStats(struct RunningStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+int histogramBucket(double value)
+{
+    int exponent;
+    double mantissa = frexp(value, &exponent); // value = mantissa * 2^exponent, mantissa in [0.5, 1)
+    int power = exponent - 1 - HISTOGRAM_MIN_EXPONENT;
+    if (power >= HISTOGRAM_EXPONENTS || isinf(value))
+        return HISTOGRAM_BUCKETS - 1;
+    return (power << HISTOGRAM_SUB_BITS) + (int)((2 * mantissa - 1) * (1 << HISTOGRAM_SUB_BITS));
+}
+
+// Function to get the lowest value that falls in the bucket
+double histogramBucketValue(int bucket)
+{
+    int power = bucket >> HISTOGRAM_SUB_BITS;
+    int sub = bucket & ((1 << HISTOGRAM_SUB_BITS) - 1);
+    return ldexp(1.0 + (double)sub / (1 << HISTOGRAM_SUB_BITS), power + HISTOGRAM_MIN_EXPONENT);
+}
+
+// Function to add a value in constant time
+void addStat(struct RunningStats *stats, double value)
+{
+    stats->count++;
+    stats->sum += value;
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+    if (stats->count == 1 || value < stats->min)
+        stats->min = value;
+    if (stats->count == 1 || value > stats->max)
+        stats->max = value;
+
+    if (!(value >= ldexp(1.0, HISTOGRAM_MIN_EXPONENT)))
+        stats->histogram.small_count++;
+    else
+        stats->histogram.counts[histogramBucket(value)]++;
+}
+
+// Function to fold the values of one set of statistics into another,
+// as if every value had been added to it
+void mergeStats(struct RunningStats *into, const struct RunningStats *from)
+{
+    if (from->count == 0)
+        return;
+    if (into->count == 0)
+    {
+        *into = *from;
+        return;
+    }
+    long long count = into->count + from->count;
+    double delta = from->mean - into->mean;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * from->count / count);
+    into->mean += delta * from->count / count;
+    into->count = count;
+    into->sum += from->sum;
+    if (from->min < into->min)
+        into->min = from->min;
+    if (from->max > into->max)
+        into->max = from->max;
+    into->histogram.small_count += from->histogram.small_count;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        into->histogram.counts[i] += from->histogram.counts[i];
+    }
+}
+
+// Function to get the value below which the fraction q of the values lie
+// (nearest rank), to within the width of a histogram bucket
+double statQuantile(const struct RunningStats *stats, double q)
+{
+    if (stats->count == 0)
+        return 0.0;
+    uint64_t rank = (uint64_t)ceil(q * stats->count);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = stats->histogram.small_count;
+    double value = stats->max;
+    if (seen >= rank)
+        value = stats->min;
+    else
+    {
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            seen += stats->histogram.counts[i];
+            if (seen >= rank)
+            {
+                value = histogramBucketValue(i);
+                break;
+            }
+        }
+    }
+    return value < stats->min ? stats->min : value > stats->max ? stats->max : value;
+}
+
+// Function to summarise the statistics for the public result
+void describeStats(const struct RunningStats *stats, struct sched_distribution *distribution)
+{
+    distribution->mean = stats->count == 0 ? 0.0 : stats->sum / stats->count;
+    distribution->stddev = stats->count == 0 ? 0.0 : sqrt(stats->m2 / stats->count);
+    distribution->p50 = statQuantile(stats, 0.50);
+    distribution->p95 = statQuantile(stats, 0.95);
+    distribution->p99 = statQuantile(stats, 0.99);
+    distribution->p999 = statQuantile(stats, 0.999);
+}
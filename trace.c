@@ -0,0 +1,479 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_NAME_LENGTH 10          // Longest process name plus the terminator
+#define TRACE_CHUNK_SIZE (1 << 20)  // Read size when the trace cannot be mapped
+#define TRACE_MAX_LINE 100          // Longest line the chunked reader must hold at once
+#define MAX_TICKETS (1 << 20)       // Most tickets a process may hold, so every stride is at least 1
+
+// Binary trace layout, all integers little-endian:
+//   header (32 bytes): "RRTB", u32 version, u64 record count,
+//                      u32 name count, u32 reserved, u64 name table offset
+//   records (20 bytes each, sorted by arrival time):
+//                      i32 arrival, i32 service time, i32 memory KB, u32 name index,
+//                      i32 tickets (0 for the default)
+//   name table:        name count entries of MAX_NAME_LENGTH bytes, NUL padded
+// Version 1 traces have 16-byte records without tickets and are still read.
+#define BINARY_TRACE_MAGIC "RRTB"
+#define BINARY_TRACE_VERSION 2
+#define BINARY_TRACE_HEADER_SIZE 32
+#define BINARY_TRACE_RECORD_SIZE 20
+#define BINARY_TRACE_V1_RECORD_SIZE 16
+
+// Define a structure to represent one line of the trace
+struct TraceRecord
+{
+    int arrival_time;
+    char name[MAX_NAME_LENGTH];
+    int service_time;
+    int memory_size;
+    int tickets; // Share of the CPU under lottery and stride, 0 for the default
+};
+
+// Define a structure to represent a trace being read one record at a time.
+// Regular files are memory-mapped; anything else (pipes, terminals) is
+// read through a chunk buffer that is refilled as the cursor reaches it.
+struct TraceReader
+{
+    int fd;
+    const char *data; // Mapped file or chunk buffer
+    size_t length;    // Bytes available in data
+    size_t offset;    // Parse cursor
+    int mapped;       // 1 if data is a mapping, 0 if it is a chunk buffer
+    int at_eof;       // 1 once the chunked reader has read the whole input
+    int has_next;     // 1 if next holds a record that has not been taken
+    struct TraceRecord next;
+    int line;         // Line number of next, for error messages
+    int failed;       // 1 if reading stopped at a malformed record
+    int binary;                 // 1 if the mapped file is a binary trace
+    uint64_t record_count;      // Records in a binary trace
+    uint64_t record_index;      // Next binary record to decode
+    int record_size;            // Bytes per binary record, which depends on the version
+    const char *names;          // Name table of a binary trace
+    uint32_t name_count;
+    const struct TraceRecord *records; // Records replayed from memory, NULL when reading a file
+};
+
+uint32_t readLittleEndian32(const char *bytes)
+{
+    const unsigned char *b = (const unsigned char *)bytes;
+    return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+uint64_t readLittleEndian64(const char *bytes)
+{
+    return (uint64_t)readLittleEndian32(bytes) | (uint64_t)readLittleEndian32(bytes + 4) << 32;
+}
+
+// Read more input behind the unparsed tail of the chunk buffer
+void refillTrace(struct TraceReader *reader)
+{
+    char *buffer = (char *)reader->data;
+    size_t left = reader->length - reader->offset;
+    memmove(buffer, buffer + reader->offset, left);
+    reader->length = left;
+    reader->offset = 0;
+    while (!reader->at_eof && reader->length < TRACE_CHUNK_SIZE)
+    {
+        ssize_t got = read(reader->fd, buffer + reader->length, TRACE_CHUNK_SIZE - reader->length);
+        if (got <= 0)
+        {
+            reader->at_eof = 1;
+            break;
+        }
+        reader->length += got;
+    }
+}
+
+int isTraceSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Skip blanks within the line (or across lines when allowed)
+void skipTraceSpace(struct TraceReader *reader, int cross_lines)
+{
+    while (reader->offset < reader->length && isTraceSpace(reader->data[reader->offset]))
+    {
+        if (!cross_lines && reader->data[reader->offset] == '\n')
+            return;
+        if (reader->data[reader->offset] == '\n')
+            reader->line++;
+        reader->offset++;
+    }
+}
+
+// Parse a decimal integer at the cursor. Returns 0 if there is none.
+int parseTraceInt(struct TraceReader *reader, int *value)
+{
+    skipTraceSpace(reader, 0);
+    int negative = 0;
+    if (reader->offset < reader->length && reader->data[reader->offset] == '-')
+    {
+        negative = 1;
+        reader->offset++;
+    }
+    if (reader->offset >= reader->length || reader->data[reader->offset] < '0' || reader->data[reader->offset] > '9')
+        return 0;
+    int result = 0;
+    while (reader->offset < reader->length && reader->data[reader->offset] >= '0' && reader->data[reader->offset] <= '9')
+    {
+        result = result * 10 + (reader->data[reader->offset] - '0');
+        reader->offset++;
+    }
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// Parse a process name at the cursor. Returns 0 if it is missing or too long.
+int parseTraceName(struct TraceReader *reader, char *name)
+{
+    skipTraceSpace(reader, 0);
+    int length = 0;
+    while (reader->offset < reader->length && !isTraceSpace(reader->data[reader->offset]))
+    {
+        if (length == MAX_NAME_LENGTH - 1)
+            return 0;
+        name[length++] = reader->data[reader->offset++];
+    }
+    name[length] = '\0';
+    return length > 0;
+}
+
+// Parse the next record into reader->next.
+// Returns 1 on success, 0 at the end of the trace and -1 on a malformed line.
+int advanceTrace(struct TraceReader *reader)
+{
+    reader->has_next = 0;
+
+    if (reader->records != NULL)
+    {
+        if (reader->record_index >= reader->record_count)
+            return 0;
+        reader->next = reader->records[reader->record_index++];
+        reader->has_next = 1;
+        return 1;
+    }
+
+    if (reader->binary)
+    {
+        if (reader->record_index >= reader->record_count)
+            return 0;
+        const char *bytes = reader->data + BINARY_TRACE_HEADER_SIZE + reader->record_index * reader->record_size;
+        uint32_t name_index = readLittleEndian32(bytes + 12);
+        if (name_index >= reader->name_count)
+        {
+            fprintf(stderr, "Error parsing input at record %llu\n", (unsigned long long)reader->record_index);
+            reader->failed = 1;
+            return -1;
+        }
+        reader->next.arrival_time = (int32_t)readLittleEndian32(bytes);
+        reader->next.service_time = (int32_t)readLittleEndian32(bytes + 4);
+        reader->next.memory_size = (int32_t)readLittleEndian32(bytes + 8);
+        reader->next.tickets = reader->record_size == BINARY_TRACE_RECORD_SIZE ? (int32_t)readLittleEndian32(bytes + 16) : 0;
+        if (reader->next.tickets < 0 || reader->next.tickets > MAX_TICKETS)
+        {
+            fprintf(stderr, "Error parsing input at record %llu\n", (unsigned long long)reader->record_index);
+            reader->failed = 1;
+            return -1;
+        }
+        memcpy(reader->next.name, reader->names + (size_t)name_index * MAX_NAME_LENGTH, MAX_NAME_LENGTH);
+        reader->next.name[MAX_NAME_LENGTH - 1] = '\0';
+        reader->record_index++;
+        reader->has_next = 1;
+        return 1;
+    }
+
+    // Skip blank lines, refilling the chunk buffer so a whole line is in view
+    while (1)
+    {
+        if (!reader->mapped && !reader->at_eof && reader->length - reader->offset < TRACE_MAX_LINE)
+            refillTrace(reader);
+        skipTraceSpace(reader, 1);
+        if (reader->offset < reader->length)
+            break;
+        if (reader->mapped || reader->at_eof)
+            return 0;
+    }
+    if (!reader->mapped && !reader->at_eof && reader->length - reader->offset < TRACE_MAX_LINE)
+        refillTrace(reader);
+
+    struct TraceRecord *record = &reader->next;
+    if (!parseTraceInt(reader, &record->arrival_time) ||
+        !parseTraceName(reader, record->name) ||
+        !parseTraceInt(reader, &record->service_time) ||
+        !parseTraceInt(reader, &record->memory_size))
+    {
+        fprintf(stderr, "Error parsing input at line %d\n", reader->line);
+        reader->failed = 1;
+        return -1;
+    }
+
+    // An optional fifth number gives the tickets of the process
+    record->tickets = 0;
+    if (parseTraceInt(reader, &record->tickets) && (record->tickets <= 0 || record->tickets > MAX_TICKETS))
+    {
+        fprintf(stderr, "Error parsing input at line %d\n", reader->line);
+        reader->failed = 1;
+        return -1;
+    }
+
+    // Ignore anything else on the line
+    while (reader->offset < reader->length && reader->data[reader->offset] != '\n')
+        reader->offset++;
+
+    reader->has_next = 1;
+    return 1;
+}
+
+// Check the header of a mapped binary trace and point the reader at its
+// records and name table. Returns 0 on success.
+int openBinaryTrace(struct TraceReader *reader)
+{
+    uint32_t version = reader->length < BINARY_TRACE_HEADER_SIZE ? 0 : readLittleEndian32(reader->data + 4);
+    if (version != 1 && version != BINARY_TRACE_VERSION)
+    {
+        fprintf(stderr, "Unsupported binary trace version\n");
+        return 1;
+    }
+    int record_size = version == 1 ? BINARY_TRACE_V1_RECORD_SIZE : BINARY_TRACE_RECORD_SIZE;
+    uint64_t record_count = readLittleEndian64(reader->data + 8);
+    uint32_t name_count = readLittleEndian32(reader->data + 16);
+    uint64_t names_offset = readLittleEndian64(reader->data + 24);
+    if (names_offset < BINARY_TRACE_HEADER_SIZE || names_offset > reader->length ||
+        (names_offset - BINARY_TRACE_HEADER_SIZE) / record_size < record_count ||
+        (reader->length - names_offset) / MAX_NAME_LENGTH < name_count)
+    {
+        fprintf(stderr, "Binary trace is truncated\n");
+        return 1;
+    }
+    reader->binary = 1;
+    reader->record_count = record_count;
+    reader->record_index = 0;
+    reader->record_size = record_size;
+    reader->names = reader->data + names_offset;
+    reader->name_count = name_count;
+    return 0;
+}
+
+void closeTrace(struct TraceReader *reader);
+
+// Function to open a trace and read its first record
+struct TraceReader *openTrace(const char *filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        perror("Error opening file");
+        return NULL;
+    }
+
+    struct TraceReader *reader = (struct TraceReader *)malloc(sizeof(struct TraceReader));
+    if (reader == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    reader->fd = fd;
+    reader->offset = 0;
+    reader->at_eof = 0;
+    reader->line = 1;
+    reader->mapped = 0;
+    reader->binary = 0;
+    reader->failed = 0;
+    reader->records = NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+            reader->data = (const char *)data;
+            reader->length = info.st_size;
+            reader->mapped = 1;
+        }
+    }
+    if (!reader->mapped)
+    {
+        reader->data = (const char *)malloc(TRACE_CHUNK_SIZE);
+        if (reader->data == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        reader->length = 0;
+    }
+
+    if (reader->mapped && reader->length >= 4 && memcmp(reader->data, BINARY_TRACE_MAGIC, 4) == 0 &&
+        openBinaryTrace(reader) != 0)
+    {
+        closeTrace(reader);
+        return NULL;
+    }
+
+    advanceTrace(reader);
+    return reader;
+}
+
+// Function to replay records that are already in memory. The records are
+// only read, so several readers may share them.
+struct TraceReader *openTraceRecords(const struct TraceRecord *records, size_t count)
+{
+    struct TraceReader *reader = (struct TraceReader *)calloc(1, sizeof(struct TraceReader));
+    if (reader == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    reader->fd = -1;
+    reader->records = records;
+    reader->record_count = count;
+    reader->record_index = 0;
+    advanceTrace(reader);
+    return reader;
+}
+
+// Function to check whether another record is waiting to be taken
+int hasTraceRecord(struct TraceReader *reader)
+{
+    return reader->has_next;
+}
+
+// Function to peek at the arrival time of the next record
+int nextTraceArrival(struct TraceReader *reader)
+{
+    return reader->next.arrival_time;
+}
+
+// Function to take the next record and read ahead to the one after it
+struct TraceRecord takeTraceRecord(struct TraceReader *reader)
+{
+    struct TraceRecord record = reader->next;
+    advanceTrace(reader);
+    return record;
+}
+
+// Function to unmap or free the input and close the trace
+void closeTrace(struct TraceReader *reader)
+{
+    if (reader->records != NULL)
+    {
+        free(reader);
+        return;
+    }
+    if (reader->mapped)
+        munmap((void *)reader->data, reader->length);
+    else
+        free((void *)reader->data);
+    close(reader->fd);
+    free(reader);
+}
+
+// Function to read a whole trace into memory.
+// Returns NULL if it cannot be opened or has a malformed record.
+struct TraceRecord *loadTrace(const char *filename, size_t *count)
+{
+    struct TraceReader *reader = openTrace(filename);
+    if (reader == NULL)
+        return NULL;
+
+    struct TraceRecord *records = NULL;
+    size_t capacity = 0;
+    *count = 0;
+    while (hasTraceRecord(reader))
+    {
+        if (*count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            records = (struct TraceRecord *)realloc(records, capacity * sizeof(struct TraceRecord));
+            if (records == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        records[(*count)++] = takeTraceRecord(reader);
+    }
+    if (reader->failed)
+    {
+        free(records);
+        records = NULL;
+    }
+    else if (records == NULL)
+        records = (struct TraceRecord *)malloc(sizeof(struct TraceRecord)); // An empty trace is still a trace
+    closeTrace(reader);
+    return records;
+}
+
+#define TRACE_TEXT 0
+#define TRACE_BINARY 1
+#define TRACE_RECORDS 2
+
+// Define a structure to represent where a reader is in its trace, as kept
+// in a snapshot. The size of the input tells a different trace apart.
+struct TracePosition
+{
+    int kind;              // TRACE_TEXT, TRACE_BINARY or TRACE_RECORDS
+    uint64_t size;         // Bytes in the file, or records in memory
+    uint64_t offset;       // Parse cursor of a text trace
+    uint64_t record_index; // Next record of a binary trace or of records in memory
+    int line;
+    int has_next;
+    struct TraceRecord next;
+};
+
+// Function to write the position of the reader. Returns 1 if it cannot be
+// captured because the input is read in chunks from a pipe.
+int saveTracePosition(struct Snapshot *snapshot, struct TraceReader *reader)
+{
+    if (reader->records == NULL && !reader->mapped)
+    {
+        fprintf(stderr, "A trace read from a pipe cannot be saved in a snapshot\n");
+        return 1;
+    }
+    struct TracePosition position;
+    memset(&position, 0, sizeof(position));
+    position.kind = reader->records != NULL ? TRACE_RECORDS : reader->binary ? TRACE_BINARY : TRACE_TEXT;
+    position.size = reader->records != NULL ? reader->record_count : reader->length;
+    position.offset = reader->offset;
+    position.record_index = reader->record_index;
+    position.line = reader->line;
+    position.has_next = reader->has_next;
+    position.next = reader->next;
+    writeSnapshot(snapshot, &position, sizeof(position));
+    return 0;
+}
+
+// Function to check that a position written by saveTracePosition() was
+// taken in the same trace as the reader holds. Returns 0 if it was.
+int checkTracePosition(struct TraceReader *reader, struct TracePosition *position)
+{
+    int kind = reader->records != NULL ? TRACE_RECORDS : reader->binary ? TRACE_BINARY : TRACE_TEXT;
+    if ((reader->records == NULL && !reader->mapped) || position->kind != kind ||
+        position->size != (reader->records != NULL ? reader->record_count : reader->length) ||
+        position->offset > reader->length || position->record_index > reader->record_count)
+    {
+        fprintf(stderr, "The snapshot was taken with a different trace\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Function to move the reader to a position checked by checkTracePosition()
+void seekTrace(struct TraceReader *reader, struct TracePosition *position)
+{
+    reader->offset = position->offset;
+    reader->record_index = position->record_index;
+    reader->line = position->line;
+    reader->has_next = position->has_next;
+    reader->next = position->next;
+    reader->failed = 0;
+}